@@ -0,0 +1,284 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "Archetype.h"
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+    size_t AlignUp(const size_t Value, const size_t Alignment)
+    {
+        return (Value + Alignment - 1) & ~(Alignment - 1);
+    }
+}
+
+Archetype::Archetype(const Signature& InSignature, const std::vector<ComponentInfo>& Infos)
+    : ArchetypeSignature(InSignature)
+{
+    ColumnLookup.resize(CoreStatics::MaxNumComponentTypes, NullID);
+    AddEdges.resize(CoreStatics::MaxNumComponentTypes, nullptr);
+    RemoveEdges.resize(CoreStatics::MaxNumComponentTypes, nullptr);
+
+    size_t rowSize = sizeof(unsigned int);
+
+    for (unsigned int componentID = InSignature.FindNext(0); componentID < Signature::NumBits; componentID = InSignature.FindNext(componentID + 1))
+    {
+        assert(componentID < Infos.size() && Infos[componentID].IsValid());
+
+        ColumnLookup[componentID] = static_cast<unsigned int>(Columns.size());
+        Columns.push_back({ componentID, Infos[componentID], 0 });
+
+        rowSize += Infos[componentID].Size;
+        TriviallyCopyable = TriviallyCopyable && Infos[componentID].TriviallyCopyable;
+
+        if (Infos[componentID].Alignment > ChunkAlignment)
+        {
+            ChunkAlignment = Infos[componentID].Alignment;
+        }
+    }
+
+    // Fit as many rows as we can into one chunk, backing off for any column padding
+    ChunkCapacity = static_cast<unsigned int>(CoreStatics::ArchetypeChunkSize / rowSize);
+
+    while (ChunkCapacity > 1 && LayoutColumns(ChunkCapacity) > CoreStatics::ArchetypeChunkSize)
+    {
+        --ChunkCapacity;
+    }
+
+    // Rows too big for a chunk still get one row per (oversized) chunk
+    if (ChunkCapacity == 0)
+    {
+        ChunkCapacity = 1;
+    }
+
+    ChunkBytes = AlignUp(LayoutColumns(ChunkCapacity), ChunkAlignment);
+}
+
+Archetype::~Archetype()
+{
+    for (Chunk& chunk : Chunks)
+    {
+        for (unsigned int row = 0; row < chunk.Count; ++row)
+        {
+            for (const Column& column : Columns)
+            {
+                column.Info.Destroy(At(column, chunk, row));
+            }
+        }
+
+        FreeChunk(chunk);
+    }
+}
+
+unsigned int* Archetype::GetEntityIDs(const unsigned int ChunkIdx)
+{
+    return reinterpret_cast<unsigned int*>(Chunks[ChunkIdx].Memory);
+}
+
+void* Archetype::GetColumn(const unsigned int ComponentID, const unsigned int ChunkIdx)
+{
+    assert(ColumnLookup[ComponentID] != NullID);
+    return Chunks[ChunkIdx].Memory + Columns[ColumnLookup[ComponentID]].Offset;
+}
+
+void* Archetype::GetComponent(const unsigned int ComponentID, const unsigned int ChunkIdx, const unsigned int Row)
+{
+    assert(ColumnLookup[ComponentID] != NullID);
+    return At(Columns[ColumnLookup[ComponentID]], Chunks[ChunkIdx], Row);
+}
+
+EntityLocation Archetype::AddRow(const unsigned int EntityID)
+{
+    if (Chunks.empty() || Chunks.back().Count == ChunkCapacity)
+    {
+        AllocateChunk();
+    }
+
+    const auto chunkIdx = static_cast<unsigned int>(Chunks.size() - 1);
+    const auto row = Chunks.back().Count++;
+    GetEntityIDs(chunkIdx)[row] = EntityID;
+
+    return { this, chunkIdx, row };
+}
+
+unsigned int Archetype::RemoveRow(const unsigned int ChunkIdx, const unsigned int Row)
+{
+    Chunk& chunk = Chunks[ChunkIdx];
+    Chunk& last = Chunks.back();
+    const auto lastChunkIdx = static_cast<unsigned int>(Chunks.size() - 1);
+    const auto lastRow = last.Count - 1;
+
+    assert(Row < chunk.Count);
+
+    for (const Column& column : Columns)
+    {
+        column.Info.Destroy(At(column, chunk, Row));
+    }
+
+    unsigned int movedID = NullID;
+
+    // Keep the chunks packed by filling the hole with the very last row
+    if (ChunkIdx != lastChunkIdx || Row != lastRow)
+    {
+        for (const Column& column : Columns)
+        {
+            void* lastComponent = At(column, last, lastRow);
+            column.Info.MoveConstruct(At(column, chunk, Row), lastComponent);
+            column.Info.Destroy(lastComponent);
+        }
+
+        movedID = GetEntityIDs(lastChunkIdx)[lastRow];
+        GetEntityIDs(ChunkIdx)[Row] = movedID;
+    }
+
+    if (--last.Count == 0)
+    {
+        FreeChunk(last);
+        Chunks.pop_back();
+    }
+
+    return movedID;
+}
+
+std::shared_ptr<const ArchetypeFrame> Archetype::SaveFrame(const ArchetypeFrame* Previous) const
+{
+    auto frame = std::make_shared<ArchetypeFrame>();
+    frame->Chunks.reserve(Chunks.size());
+    frame->Counts.reserve(Chunks.size());
+
+    for (size_t idx = 0; idx < Chunks.size(); ++idx)
+    {
+        frame->Counts.push_back(Chunks[idx].Count);
+
+        if (TriviallyCopyable)
+        {
+            const FramePage* previous = (Previous != nullptr && idx < Previous->Chunks.size()) ? &Previous->Chunks[idx] : nullptr;
+            frame->Chunks.push_back(FramePage::Capture(Chunks[idx].Memory, ChunkBytes, previous));
+        }
+        else
+        {
+            frame->Chunks.push_back(CopyChunk(Chunks[idx]));
+        }
+    }
+
+    return frame;
+}
+
+void Archetype::RestoreFrame(const ArchetypeFrame& Frame)
+{
+    if (TriviallyCopyable == false)
+    {
+        for (Chunk& chunk : Chunks)
+        {
+            for (unsigned int row = 0; row < chunk.Count; ++row)
+            {
+                for (const Column& column : Columns)
+                {
+                    column.Info.Destroy(At(column, chunk, row));
+                }
+            }
+        }
+    }
+
+    while (Chunks.size() > Frame.Counts.size())
+    {
+        FreeChunk(Chunks.back());
+        Chunks.pop_back();
+    }
+
+    while (Chunks.size() < Frame.Counts.size())
+    {
+        AllocateChunk();
+    }
+
+    for (size_t idx = 0; idx < Chunks.size(); ++idx)
+    {
+        Chunk& chunk = Chunks[idx];
+        const unsigned char* source = Frame.Chunks[idx].Bytes.get();
+        chunk.Count = Frame.Counts[idx];
+
+        if (TriviallyCopyable)
+        {
+            std::memcpy(chunk.Memory, source, ChunkBytes);
+            continue;
+        }
+
+        std::memcpy(chunk.Memory, source, sizeof(unsigned int) * chunk.Count);
+
+        for (const Column& column : Columns)
+        {
+            if (column.Info.TriviallyCopyable)
+            {
+                std::memcpy(chunk.Memory + column.Offset, source + column.Offset, column.Info.Size * chunk.Count);
+                continue;
+            }
+
+            for (unsigned int row = 0; row < chunk.Count; ++row)
+            {
+                column.Info.CopyConstruct(At(column, chunk, row), source + column.Offset + column.Info.Size * row);
+            }
+        }
+    }
+}
+
+FramePage Archetype::CopyChunk(const Chunk& InChunk) const
+{
+    auto* memory = static_cast<unsigned char*>(::operator new(ChunkBytes, std::align_val_t(ChunkAlignment)));
+    Chunk copy{ memory, InChunk.Count };
+
+    std::memcpy(memory, InChunk.Memory, sizeof(unsigned int) * InChunk.Count);
+
+    for (const Column& column : Columns)
+    {
+        for (unsigned int row = 0; row < InChunk.Count; ++row)
+        {
+            column.Info.CopyConstruct(At(column, copy, row), At(column, InChunk, row));
+        }
+    }
+
+    // The frame can outlive this archetype, so the deleter keeps its own copy of the columns
+    const auto release = [columns = Columns, copy, alignment = ChunkAlignment](const unsigned char*)
+    {
+        for (const Column& column : columns)
+        {
+            for (unsigned int row = 0; row < copy.Count; ++row)
+            {
+                column.Info.Destroy(copy.Memory + column.Offset + column.Info.Size * row);
+            }
+        }
+
+        ::operator delete(copy.Memory, std::align_val_t(alignment));
+    };
+
+    return { std::shared_ptr<const unsigned char[]>(memory, release), ChunkBytes };
+}
+
+size_t Archetype::LayoutColumns(const unsigned int Capacity)
+{
+    size_t offset = sizeof(unsigned int) * Capacity;
+
+    for (Column& column : Columns)
+    {
+        offset = AlignUp(offset, column.Info.Alignment);
+        column.Offset = offset;
+        offset += column.Info.Size * Capacity;
+    }
+
+    return offset;
+}
+
+void Archetype::AllocateChunk()
+{
+    Chunk chunk;
+    chunk.Memory = static_cast<unsigned char*>(::operator new(ChunkBytes, std::align_val_t(ChunkAlignment)));
+    Chunks.push_back(chunk);
+}
+
+void Archetype::FreeChunk(Chunk& InChunk)
+{
+    ::operator delete(InChunk.Memory, std::align_val_t(ChunkAlignment));
+    InChunk.Memory = nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "Signature.h"
+#include "Rollback.h"
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+/**
+ * Type-erased operations for one component type, so archetypes can move, copy and destroy
+ * components without knowing their types.
+ * Tag components (empty types) get a zero-size column: the archetype's signature records
+ * them but no bytes are stored.
+ */
+struct ComponentInfo
+{
+    size_t Size = 0;
+    size_t Alignment = 0;
+    void (*MoveConstruct)(void* Dst, void* Src) = nullptr;
+    void (*CopyConstruct)(void* Dst, const void* Src) = nullptr;
+    void (*Destroy)(void* Target) = nullptr;
+
+    /** Can be copied with memcpy and needs no destructor */
+    bool TriviallyCopyable = true;
+
+    const bool IsValid() const { return MoveConstruct != nullptr; }
+
+    template <typename TComponent>
+    static ComponentInfo Create()
+    {
+        ComponentInfo info;
+
+        if constexpr (std::is_empty_v<TComponent>)
+        {
+            info.Alignment = 1;
+            info.MoveConstruct = [](void* Dst, void* Src) {};
+            info.CopyConstruct = [](void* Dst, const void* Src) {};
+            info.Destroy = [](void* Target) {};
+            return info;
+        }
+
+        info.Size = sizeof(TComponent);
+        info.Alignment = alignof(TComponent);
+        info.TriviallyCopyable = std::is_trivially_copyable_v<TComponent>;
+        info.MoveConstruct = [](void* Dst, void* Src)
+        {
+            new (Dst) TComponent(std::move(*static_cast<TComponent*>(Src)));
+        };
+        info.CopyConstruct = [](void* Dst, const void* Src)
+        {
+            new (Dst) TComponent(*static_cast<const TComponent*>(Src));
+        };
+        info.Destroy = [](void* Target)
+        {
+            static_cast<TComponent*>(Target)->~TComponent();
+        };
+        return info;
+    }
+};
+
+/**
+ * Where an entity's components live when using archetype storage.
+ * Owner is nullptr for entities that have no components.
+ */
+struct EntityLocation
+{
+    class Archetype* Owner = nullptr;
+    unsigned int Chunk = 0;
+    unsigned int Row = 0;
+};
+
+/**
+ * An archetype's rows as of some frame, see Archetype::SaveFrame.
+ * Chunks[i] is a copy of chunk i's memory holding Counts[i] rows.
+ */
+struct ArchetypeFrame
+{
+    std::vector<FramePage> Chunks;
+    std::vector<unsigned int> Counts;
+};
+
+/**
+ * All entities that share one exact Signature.
+ * Their components are stored in fixed-size chunks (CoreStatics::ArchetypeChunkSize) laid
+ * out as structure-of-arrays: the entity ID column first, then one column per component
+ * type in component ID order. Systems can walk a column linearly instead of looking up
+ * each entity's component in a separate pool.
+ *
+ * Rows are kept packed - removing a row moves the very last row of the last chunk into
+ * the hole, so every chunk but the last is always full.
+ */
+class Archetype
+{
+public:
+    static constexpr unsigned int NullID = static_cast<unsigned int>(-1);
+
+    /** Infos is indexed by component ID and must be valid for every bit set in InSignature */
+    Archetype(const Signature& InSignature, const std::vector<ComponentInfo>& Infos);
+    ~Archetype();
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    const Signature& GetSignature() const { return ArchetypeSignature; }
+    const bool HasColumn(const unsigned int ComponentID) const { return ArchetypeSignature.test(ComponentID); }
+
+    const size_t GetNumChunks() const { return Chunks.size(); }
+    const unsigned int GetChunkCapacity() const { return ChunkCapacity; }
+    const unsigned int GetChunkCount(const unsigned int ChunkIdx) const { return Chunks[ChunkIdx].Count; }
+
+    unsigned int* GetEntityIDs(const unsigned int ChunkIdx);
+    void* GetColumn(const unsigned int ComponentID, const unsigned int ChunkIdx);
+    void* GetComponent(const unsigned int ComponentID, const unsigned int ChunkIdx, const unsigned int Row);
+
+    template <typename TComponent>
+    TComponent* GetColumn(const unsigned int ComponentID, const unsigned int ChunkIdx)
+    {
+        return static_cast<TComponent*>(GetColumn(ComponentID, ChunkIdx));
+    }
+
+    /**
+     * Reserves a row for EntityID at the end of the archetype.
+     * The components in the row are left uninitialized - the caller must construct every column.
+     */
+    EntityLocation AddRow(const unsigned int EntityID);
+
+    /**
+     * Destroys the components in a row and fills the hole with the last row.
+     * Returns the ID of the entity that was moved into the hole, or NullID if none was.
+     */
+    unsigned int RemoveRow(const unsigned int ChunkIdx, const unsigned int Row);
+
+    /**
+     * Copies every row. If every component is trivially copyable, whole chunks are copied and
+     * chunks whose bytes match Previous (this archetype's last saved frame, or nullptr) are
+     * shared with it. Otherwise each component is copy-constructed into the frame.
+     */
+    std::shared_ptr<const ArchetypeFrame> SaveFrame(const ArchetypeFrame* Previous) const;
+
+    /** Replaces every row with the ones in Frame, in the same chunks and order */
+    void RestoreFrame(const ArchetypeFrame& Frame);
+
+    /** Cached neighbours in the archetype graph, indexed by component ID (nullptr if not yet visited) */
+    Archetype*& AddEdge(const unsigned int ComponentID) { return AddEdges[ComponentID]; }
+    Archetype*& RemoveEdge(const unsigned int ComponentID) { return RemoveEdges[ComponentID]; }
+
+private:
+    struct Column
+    {
+        unsigned int ComponentID;
+        ComponentInfo Info;
+        size_t Offset;
+    };
+
+    struct Chunk
+    {
+        unsigned char* Memory = nullptr;
+        unsigned int Count = 0;
+    };
+
+    void* At(const Column& InColumn, const Chunk& InChunk, const unsigned int Row) const
+    {
+        return InChunk.Memory + InColumn.Offset + InColumn.Info.Size * Row;
+    }
+
+    /** Copy of InChunk's rows with every component copy-constructed, destroying them again when released */
+    FramePage CopyChunk(const Chunk& InChunk) const;
+
+    /** Assigns column offsets for Capacity rows and returns the total bytes needed, including padding */
+    size_t LayoutColumns(const unsigned int Capacity);
+
+    void AllocateChunk();
+    void FreeChunk(Chunk& InChunk);
+
+    Signature ArchetypeSignature;
+    std::vector<Column> Columns;
+
+    /** Index into Columns by component ID, or NullID if this archetype lacks that component */
+    std::vector<unsigned int> ColumnLookup;
+
+    std::vector<Chunk> Chunks;
+    unsigned int ChunkCapacity = 0;
+    size_t ChunkBytes = 0;
+    size_t ChunkAlignment = alignof(unsigned int);
+
+    /** Every column can be copied with memcpy, so whole chunks can be too */
+    bool TriviallyCopyable = true;
+
+    std::vector<Archetype*> AddEdges;
+    std::vector<Archetype*> RemoveEdges;
+};
\ No newline at end of file
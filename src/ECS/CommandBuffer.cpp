@@ -0,0 +1,46 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "CommandBuffer.h"
+
+Entity CommandBuffer::CreateEntity()
+{
+    const Entity entity = Owner->ReserveEntity();
+    Created.push_back(entity);
+
+    return entity;
+}
+
+const bool CommandBuffer::Empty() const
+{
+    if (Created.empty() == false || Killed.empty() == false)
+    {
+        return false;
+    }
+
+    for (const std::unique_ptr<IComponentCommandList>& commands : ComponentCommands)
+    {
+        if (commands != nullptr && commands->Empty() == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CommandBuffer::Clear()
+{
+    Created.clear();
+    Killed.clear();
+
+    for (const std::unique_ptr<IComponentCommandList>& commands : ComponentCommands)
+    {
+        if (commands != nullptr)
+        {
+            commands->Clear();
+        }
+    }
+}
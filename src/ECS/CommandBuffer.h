@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "ECS.h"
+#include <vector>
+#include <memory>
+#include <optional>
+
+/**
+ * Type-erased list of recorded adds/removes for one component type
+ */
+class IComponentCommandList
+{
+public:
+    virtual ~IComponentCommandList() = default;
+
+    virtual const bool Empty() const = 0;
+    virtual const unsigned int NumAdds() const = 0;
+    virtual void Clear() = 0;
+
+    /** Makes room in Manager's storage for NumNew more of this component */
+    virtual void Reserve(ECSManager& Manager, const unsigned int NumNew) = 0;
+
+    /** Applies every command in recorded order, skipping entities that are no longer alive */
+    virtual void Playback(ECSManager& Manager) = 0;
+};
+
+template <typename TComponent>
+class ComponentCommandList : public IComponentCommandList
+{
+public:
+    template <typename ...TArgs>
+    void Add(const Entity InEntity, TArgs&& ...Args)
+    {
+        Commands.push_back({ InEntity, std::optional<TComponent>(std::in_place, std::forward<TArgs>(Args)...) });
+        ++NumAdded;
+    }
+
+    void Remove(const Entity InEntity)
+    {
+        Commands.push_back({ InEntity, std::nullopt });
+    }
+
+    const bool Empty() const override { return Commands.empty(); }
+    const unsigned int NumAdds() const override { return NumAdded; }
+    void Clear() override { Commands.clear(); NumAdded = 0; }
+
+    void Reserve(ECSManager& Manager, const unsigned int NumNew) override;
+    void Playback(ECSManager& Manager) override;
+
+private:
+    struct Command
+    {
+        Entity Target;
+
+        /** The component to add, or nullopt to remove it */
+        std::optional<TComponent> Value;
+    };
+
+    std::vector<Command> Commands;
+    unsigned int NumAdded = 0;
+};
+
+/**
+ * Records entity and component changes to be applied later by ECSManager::PlaybackCommandBuffers,
+ * instead of changing signatures, pools and system entity lists on the spot.
+ * Each thread gets its own from ECSManager::GetCommandBuffer, so recording never needs a lock
+ * (except CreateEntity, which has to reserve a real handle straight away).
+ */
+class CommandBuffer
+{
+public:
+    CommandBuffer(ECSManager* InOwner) : Owner(InOwner) {}
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    /** 
+     * Returns the new entity's handle right away so components can be recorded for it, 
+     * but it is not alive until playback.
+     */
+    Entity CreateEntity();
+
+    void Kill(const Entity InEntity) { Killed.push_back(InEntity); }
+
+    /**
+     * TComponent is constructed from Args now and moved into storage on playback.
+     */
+    template <typename TComponent, typename ...TArgs>
+    void AddComponent(const Entity InEntity, TArgs&& ...Args);
+
+    template <typename TComponent>
+    void RemoveComponent(const Entity InEntity);
+
+    const bool Empty() const;
+    void Clear();
+
+private:
+    friend class ECSManager;
+
+    template <typename TComponent>
+    ComponentCommandList<TComponent>& GetCommandList();
+
+    ECSManager* Owner;
+
+    std::vector<Entity> Created;
+    std::vector<Entity> Killed;
+
+    /**
+     * Index indicates ComponentID, value is the commands recorded for that component type
+     */
+    std::vector<std::unique_ptr<IComponentCommandList>> ComponentCommands;
+};
+
+template <typename TComponent>
+void ComponentCommandList<TComponent>::Reserve(ECSManager& Manager, const unsigned int NumNew)
+{
+    // Archetype chunks are allocated as they fill and tags have no pool, there is nothing to grow up front
+    if (Manager.GetStorageMode() == EStorageMode::SparseSet && IsTagComponent<TComponent> == false)
+    {
+        Pool<TComponent>* pool = Manager.GetOrCreateComponentPool<TComponent>();
+        pool->Reserve(pool->Size() + NumNew);
+    }
+}
+
+template <typename TComponent>
+void ComponentCommandList<TComponent>::Playback(ECSManager& Manager)
+{
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    for (Command& command : Commands)
+    {
+        if (Manager.IsAlive(command.Target) == false)
+        {
+            continue;
+        }
+
+        const auto entityID = command.Target.GetID();
+        Signature& signature = Manager.EntityComponentSignatures[entityID];
+
+        if (command.Value.has_value())
+        {
+            Manager.TouchForPlayback(command.Target);
+            Manager.StoreComponent<TComponent>(entityID, std::move(*command.Value));
+
+            if (signature.test(componentID) == false)
+            {
+                Manager.NotifyAdded(componentID, command.Target);
+                signature.set(componentID);
+            }
+        }
+        else if (signature.test(componentID))
+        {
+            Manager.TouchForPlayback(command.Target);
+            Manager.EraseComponent(entityID, componentID);
+            Manager.NotifyRemoved(componentID, command.Target);
+            Manager.SetDisabledBit(entityID, componentID, false);
+            signature.set(componentID, false);
+        }
+    }
+}
+
+template <typename TComponent, typename ...TArgs>
+void CommandBuffer::AddComponent(const Entity InEntity, TArgs&& ...Args)
+{
+    GetCommandList<TComponent>().Add(InEntity, std::forward<TArgs>(Args)...);
+}
+
+template <typename TComponent>
+void CommandBuffer::RemoveComponent(const Entity InEntity)
+{
+    GetCommandList<TComponent>().Remove(InEntity);
+}
+
+template <typename TComponent>
+ComponentCommandList<TComponent>& CommandBuffer::GetCommandList()
+{
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    if (componentID >= ComponentCommands.size())
+    {
+        ComponentCommands.resize(CoreStatics::MaxNumComponentTypes);
+    }
+
+    if (ComponentCommands[componentID] == nullptr)
+    {
+        ComponentCommands[componentID] = std::make_unique<ComponentCommandList<TComponent>>();
+    }
+
+    return static_cast<ComponentCommandList<TComponent>&>(*ComponentCommands[componentID]);
+}
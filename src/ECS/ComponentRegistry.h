@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include <type_traits>
+
+/**
+ * A list of types, only ever used at compile time
+ */
+template <typename ...Ts>
+struct TypeList {};
+
+template <typename TList>
+struct TypeListSize;
+
+template <typename ...Ts>
+struct TypeListSize<TypeList<Ts...>> : std::integral_constant<unsigned int, sizeof...(Ts)> {};
+
+/**
+ * Index of T in TList, or TList's size if T is not in it.
+ * Only compares types, so they can all be incomplete.
+ */
+template <typename T, typename TList>
+struct TypeListIndex;
+
+template <typename T>
+struct TypeListIndex<T, TypeList<>> : std::integral_constant<unsigned int, 0> {};
+
+template <typename T, typename ...Ts>
+struct TypeListIndex<T, TypeList<T, Ts...>> : std::integral_constant<unsigned int, 0> {};
+
+template <typename T, typename TFirst, typename ...Ts>
+struct TypeListIndex<T, TypeList<TFirst, Ts...>>
+    : std::integral_constant<unsigned int, 1 + TypeListIndex<T, TypeList<Ts...>>::value> {};
+
+class TransformComponent;
+class RigidBodyComponent;
+class SpriteComponent;
+class BoxColliderComponent;
+class AnimationComponent;
+class HierarchyComponent;
+class WorldTransformComponent;
+
+/**
+ * Every component type. A component's ID is its index in this list, so IDs - and the signatures,
+ * snapshots and replays built on them - are the same in every run and every build, and
+ * Component<T>::GetID() is a compile-time constant.
+ *
+ * New components go on the END. Reordering or removing an entry changes the ID of everything
+ * after it, which breaks any data saved with the old IDs.
+ * Snapshot.cpp builds save/load ops for every type here, so include each one's header there too.
+ */
+typedef TypeList<
+    TransformComponent,
+    RigidBodyComponent,
+    SpriteComponent,
+    BoxColliderComponent,
+    AnimationComponent,
+    HierarchyComponent,
+    WorldTransformComponent
+> ComponentTypes;
@@ -14,7 +14,7 @@ public:
         const int FrameRate = 5, const bool ShouldLoop = true) :
         NumFrames(NumFrames), CurrentFrame(CurrentFrame), 
         FrameRate(FrameRate), ShouldLoop(ShouldLoop), 
-        SecondsPerFrame(1.0f / FrameRate), NextFrameUpdateTime(SecondsPerFrame) {}
+        SecondsPerFrame(1.0f / FrameRate), NextFrameUpdateTime(SecondsPerFrame), ElapsedTime(0.0f) {}
 
     size_t NumFrames;
     size_t CurrentFrame;
@@ -22,4 +22,7 @@ public:
     bool ShouldLoop;
     float SecondsPerFrame;
     float NextFrameUpdateTime;
+
+    /** Simulated seconds the animation has run for, summed from each Update's DeltaTime */
+    float ElapsedTime;
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include "ECS/ECS.h"
 #include "glm/glm.hpp"
+#include "Util/AABB.h"
 
 using Vector2 = glm::vec2;
 
@@ -16,25 +17,14 @@ public:
     BoxColliderComponent(const int Width = 0, const int Height = 0, 
         const Vector2 Offset = {0, 0}) : Width(Width), Height(Height), Offset(Offset) {}
 
-    void AddCollision(const unsigned int Other)
+    /** World space box of a collider on an entity at Position */
+    AABB GetBounds(const Vector2 Position) const
     {
-        CollidingEntities.insert(Other);
-    }
-
-    void RemoveCollision(const unsigned int Other)
-    {
-        CollidingEntities.erase(Other);
-    }
-
-    const bool IsCollidingWith(const unsigned int Other) const
-    {
-        return CollidingEntities.count(Other);
+        const Vector2 min = Position + Offset;
+        return { min, min + Vector2(Width, Height) };
     }
 
     int Width;
     int Height;
     Vector2 Offset;
-
-private:
-    std::unordered_set<unsigned int> CollidingEntities;
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "ECS/ECS.h"
+
+/**
+ * Links an entity into a parent/child tree. Children are a singly linked list: the parent 
+ * points at its first child, each child at its next sibling.
+ * Don't edit the links directly, use HierarchySystem::SetParent/Detach/DestroyEntity.
+ */
+class HierarchyComponent : public Component<HierarchyComponent>
+{
+public:
+    Entity Parent;
+    Entity FirstChild;
+    Entity NextSibling;
+};
\ No newline at end of file
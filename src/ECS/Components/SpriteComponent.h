@@ -41,4 +41,23 @@ public:
     {
         SourceRect = { SourceRectX, SourceRectY, Width, Height };
     }
+
+    /** AssetID keeps this from being saved as raw bytes, see ECSManager::SaveSnapshot */
+    void Serialize(SnapshotWriter& Writer) const
+    {
+        Writer.WriteString(AssetID);
+        Writer.Write(Width);
+        Writer.Write(Height);
+        Writer.Write(ZOrder);
+        Writer.Write(SourceRect);
+    }
+
+    void Deserialize(SnapshotReader& Reader)
+    {
+        AssetID = Reader.ReadString();
+        Reader.Read(Width);
+        Reader.Read(Height);
+        Reader.Read(ZOrder);
+        Reader.Read(SourceRect);
+    }
 };
\ No newline at end of file
@@ -14,9 +14,14 @@ class TransformComponent : public Component<TransformComponent>
 {
 public:
     TransformComponent(Vector2 Position = {0, 0}, Vector2 Scale = {1, 1}, 
-        double Rotation = 0.0f) : Position(Position), Scale(Scale), Rotation(Rotation) {}
+        double Rotation = 0.0f) : Position(Position), Scale(Scale), Rotation(Rotation),
+        PreviousPosition(Position), PreviousRotation(Rotation) {}
 
     Vector2 Position;
     Vector2 Scale;
     double Rotation;
+
+    /** State as of the previous simulation tick, rendering blends from here towards the current state */
+    Vector2 PreviousPosition;
+    double PreviousRotation;
 };
\ No newline at end of file
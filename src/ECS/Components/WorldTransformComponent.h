@@ -0,0 +1,31 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "ECS/ECS.h"
+#include "glm/glm.hpp"
+
+using Vector2 = glm::vec2;
+
+/**
+ * An entity's TransformComponent combined with all of its parents', computed by HierarchySystem.
+ * Read-only everywhere else.
+ */
+class WorldTransformComponent : public Component<WorldTransformComponent>
+{
+public:
+    WorldTransformComponent(Vector2 Position = {0, 0}, Vector2 Scale = {1, 1}, 
+        double Rotation = 0.0f) : Position(Position), Scale(Scale), Rotation(Rotation),
+        PreviousPosition(Position), PreviousRotation(Rotation) {}
+
+    Vector2 Position;
+    Vector2 Scale;
+    double Rotation;
+
+    /** State as of the previous simulation tick, rendering blends from here towards the current state */
+    Vector2 PreviousPosition;
+    double PreviousRotation;
+};
\ No newline at end of file
@@ -4,61 +4,96 @@
  */
 
 #include "ECS.h"
+#include "CommandBuffer.h"
+#include "Util/JobSystem.h"
+#include <condition_variable>
 
-Entity::Entity(ECSManager* Owner /*= nullptr*/) : Owner(Owner)
+const bool Entity::IsAlive() const
 {
-    assert(++NumEntities < CoreStatics::MaxNumEntities);
-
-    if (Owner != nullptr)
-    {
-        auto& freeIDs = Owner->GetFreeEntityIDs();
-        if (freeIDs.empty() == false)
-        {
-            EntityID = freeIDs.front();
-            freeIDs.pop();
-        }
-        else
-        {
-            EntityID = NumEntities;
-        }
-    }
+    return ECSManager::GetActive() != nullptr && ECSManager::GetActive()->IsAlive(*this);
 }
 
 void Entity::Kill() const
 {
-    if (Owner != nullptr)
+    if (ECSManager* owner = ECSManager::GetActive())
     {
-        Owner->DestroyEntity(*this);
+        owner->DestroyEntity(*this);
     }
 }
 
-unsigned int Entity::NumEntities = 0;
-unsigned int IComponent::NumComponentTypes = 0;
+ECSManager* ECSManager::Active = nullptr;
 
 void System::AddEntity(const Entity InEntity)
 {
-    const auto entityID = InEntity.GetID();
-
-    if (EntityIDs.count(entityID) == 0)
+    if (EntityIDs.Contains(InEntity.GetID()) == false)
     {
-        EntityIDs.insert(entityID);
+        EntityIDs.Insert(InEntity.GetID());
         Entities.push_back(InEntity);
     }
 }
 
+void System::AddEntities(const std::vector<Entity>& EntitiesToAdd)
+{
+    Entities.reserve(Entities.size() + EntitiesToAdd.size());
+    EntityIDs.Reserve(EntityIDs.Size() + EntitiesToAdd.size());
+
+    for (const Entity& entity : EntitiesToAdd)
+    {
+        AddEntity(entity);
+    }
+}
+
 void System::RemoveEntity(const Entity InEntity)
 {
-    const auto entityID = InEntity.GetID();
+    const auto idx = EntityIDs.Remove(InEntity.GetID());
 
-    if (EntityIDs.count(entityID))
+    if (idx != SparseSet::NullIndex)
     {
-        EntityIDs.erase(entityID);
-        Entities.erase(std::find(Entities.begin(), Entities.end(), InEntity));
+        // Mirror the swap-and-pop the sparse set just did
+        if (idx != Entities.size() - 1)
+        {
+            Entities[idx] = Entities.back();
+        }
+        Entities.pop_back();
+    }
+}
+
+const bool System::ConflictsWith(const System& Other) const
+{
+    // Undeclared access could be anything
+    if (AccessDeclared == false || Other.AccessDeclared == false)
+    {
+        return true;
+    }
+
+    const Signature otherAccess = Other.ReadSignature | Other.WriteSignature;
+    const Signature access = ReadSignature | WriteSignature;
+
+    return WriteSignature.Intersects(otherAccess) || Other.WriteSignature.Intersects(access);
+}
+
+ECSManager::ECSManager(const EStorageMode Mode /*= EStorageMode::SparseSet*/) : StorageMode(Mode)
+{
+    ComponentVersions.resize(CoreStatics::MaxNumComponentTypes);
+    ComponentTypeVersions.resize(CoreStatics::MaxNumComponentTypes, 0);
+    ChangeLogs.resize(CoreStatics::MaxNumComponentTypes);
+    Observers.resize(CoreStatics::MaxNumComponentTypes);
+    NumDisabled.resize(CoreStatics::MaxNumComponentTypes, 0);
+    RollbackFrames.resize(CoreStatics::NumRollbackFrames);
+
+    if (Active == nullptr)
+    {
+        Active = this;
     }
 }
 
 ECSManager::~ECSManager()
 {
+    if (Active == this)
+    {
+        Active = nullptr;
+    }
+
     for (IPool* pool : ComponentPools)
     {
         delete pool;
@@ -68,94 +103,916 @@ ECSManager::~ECSManager()
     {
         delete pair.second;
     }
+
+    for (Archetype* archetype : ArchetypeList)
+    {
+        delete archetype;
+    }
 }
 
 Entity ECSManager::CreateEntity()
 {
-    Entity entity(this);
-    EntitiesToBeAdded.insert(entity);
+    Entity entity = ReserveEntity();
+    RegisterEntity(entity);
+
+    return entity;
+}
+
+Entity ECSManager::ReserveEntity()
+{
+    std::lock_guard<std::mutex> lock(EntityIDMutex);
+
+    unsigned int entityID = 0;
+
+    if (FreeEntityIDs.empty() == false)
+    {
+        entityID = FreeEntityIDs.front();
+        FreeEntityIDs.pop();
+    }
+    else
+    {
+        entityID = NextEntityID++;
+        assert(entityID < CoreStatics::MaxNumEntities);
+    }
+
+    MarkLayoutChanged();
+
+    // Never-used IDs start at generation 0, storage for them may not exist yet
+    const unsigned int generation = (entityID < EntityGenerations.size()) ? EntityGenerations[entityID] : 0;
+
+    return Entity(entityID, generation);
+}
+
+void ECSManager::RegisterEntity(const Entity InEntity)
+{
+    {
+        std::lock_guard<std::mutex> lock(EntityIDMutex);
+        ResizeEntityStorage(InEntity.GetID());
+    }
+
+    EntitiesToBeAdded.push_back(InEntity);
     ++NumEntities;
+    MarkLayoutChanged();
+}
 
-    if (entity.GetID() >= EntityComponentSignatures.size())
+void ECSManager::DestroyEntity(const Entity InEntity)
+{
+    if (IsAlive(InEntity))
     {
-        EntityComponentSignatures.resize(entity.GetID() * 2);
+        const auto entityID = InEntity.GetID();
+
+        // Bump the generation now so every copy of this handle reads as dead straight away.
+        // The ID itself is only recycled once Update() has cleared out the old components.
+        EntityGenerations[entityID] = (EntityGenerations[entityID] + 1) & Entity::GenerationMask;
+        EntitiesToBeRemoved.push_back(InEntity);
+        --NumEntities;
+        MarkLayoutChanged();
     }
+}
 
-    return entity;
+std::vector<Entity> ECSManager::ReserveEntities(const unsigned int Count)
+{
+    std::lock_guard<std::mutex> lock(EntityIDMutex);
+
+    std::vector<unsigned int> entityIDs;
+    entityIDs.reserve(Count);
+
+    while (entityIDs.size() < Count && FreeEntityIDs.empty() == false)
+    {
+        entityIDs.push_back(FreeEntityIDs.front());
+        FreeEntityIDs.pop();
+    }
+
+    while (entityIDs.size() < Count)
+    {
+        assert(NextEntityID < CoreStatics::MaxNumEntities);
+        entityIDs.push_back(NextEntityID++);
+    }
+
+    MarkLayoutChanged();
+
+    std::vector<Entity> entities;
+    entities.reserve(Count);
+
+    if (Count > 0)
+    {
+        ResizeEntityStorage(*std::max_element(entityIDs.begin(), entityIDs.end()));
+    }
+
+    for (const unsigned int entityID : entityIDs)
+    {
+        entities.push_back(Entity(entityID, EntityGenerations[entityID]));
+    }
+
+    NumEntities += Count;
+
+    return entities;
 }
 
-void ECSManager::DestroyEntity(Entity InEntity)
+const bool ECSManager::IsAlive(const Entity InEntity) const
 {
-    EntitiesToBeRemoved.insert(InEntity);
-    FreeEntityIDs.push(InEntity.GetID());
+    const auto entityID = InEntity.GetID();
+
+    return InEntity.IsNull() == false && 
+        entityID < EntityGenerations.size() && 
+        EntityGenerations[entityID] == InEntity.GetGeneration();
 }
 
 void ECSManager::AddEntityToSystems(const Entity InEntity)
 {
     assert(InEntity.GetID() < EntityComponentSignatures.size());
-    
-    const Signature& entitySignature = EntityComponentSignatures[InEntity.GetID()];
 
-    for (const auto& [typeIndex, system] : Systems)
+    MarkLayoutChanged();
+
+    for (System* system : GetMembership(GetEnabledSignature(InEntity.GetID())).Systems)
     {
-        const Signature& systemSignature = system->GetComponentSignature();
-        if ((systemSignature & entitySignature) == systemSignature)
+        system->AddEntity(InEntity);
+    }
+}
+
+void ECSManager::AddEntitiesToSystems(const std::vector<Entity>& InEntities, const Signature& InSignature)
+{
+    const SystemMembership& membership = GetMembership(InSignature);
+    MarkLayoutChanged();
+
+    for (System* system : membership.Systems)
+    {
+        system->AddEntities(InEntities);
+    }
+
+    for (ViewCache* cache : membership.Views)
+    {
+        cache->EntityIDs.Reserve(cache->EntityIDs.Size() + InEntities.size());
+
+        for (const Entity& entity : InEntities)
         {
-            system->AddEntity(InEntity);
+            if (cache->EntityIDs.Contains(entity.GetID()) == false)
+            {
+                cache->EntityIDs.Insert(entity.GetID());
+            }
         }
     }
 }
 
 void ECSManager::RemoveEntityFromSystems(const Entity InEntity)
 {
-    const Signature& entitySignature = EntityComponentSignatures[InEntity.GetID()];
+    const SystemMembership& membership = GetMembership(GetEnabledSignature(InEntity.GetID()));
+    MarkLayoutChanged();
 
-    for (const auto& [typeIndex, system] : Systems)
+    for (System* system : membership.Systems)
     {
-        const Signature& systemSignature = system->GetComponentSignature();
-        if ((systemSignature & entitySignature) == systemSignature)
+        system->RemoveEntity(InEntity);
+    }
+
+    for (ViewCache* cache : membership.Views)
+    {
+        cache->EntityIDs.Remove(InEntity.GetID());
+    }
+}
+
+void ECSManager::UpdateEntityInSystems(const Entity InEntity, const Signature& Old, const Signature& New)
+{
+    if (Old != New)
+    {
+        MarkLayoutChanged();
+
+        const SystemMembershipDelta& delta = GetMembershipDelta(Old, New);
+
+        for (System* system : delta.Removed.Systems)
         {
             system->RemoveEntity(InEntity);
         }
+
+        for (System* system : delta.Added.Systems)
+        {
+            system->AddEntity(InEntity);
+        }
+
+        for (ViewCache* cache : delta.Removed.Views)
+        {
+            cache->EntityIDs.Remove(InEntity.GetID());
+        }
+
+        for (ViewCache* cache : delta.Added.Views)
+        {
+            cache->EntityIDs.Insert(InEntity.GetID());
+        }
     }
 }
 
-void ECSManager::UpdateEntityInSystems(const Entity InEntity, const Signature& Old, const Signature& New)
+const SystemMembership& ECSManager::GetMembership(const Signature& InSignature)
 {
-    if (Old != New)
+    const auto cached = MembershipCache.find(InSignature);
+
+    if (cached != MembershipCache.end())
+    {
+        return cached->second;
+    }
+
+    SystemMembership& membership = MembershipCache[InSignature];
+
+    for (System* system : SystemOrder)
+    {
+        const Signature& systemSignature = system->GetComponentSignature();
+        if (InSignature.Contains(systemSignature))
+        {
+            membership.Systems.push_back(system);
+        }
+    }
+
+    for (auto& [required, cache] : ViewCaches)
     {
-        for (const auto& [typeIndex, system] : Systems)
+        if (InSignature.Contains(required))
         {
-            const Signature& systemSignature = system->GetComponentSignature();
-            if ((systemSignature & Old) == systemSignature)
+            membership.Views.push_back(&cache);
+        }
+    }
+
+    return membership;
+}
+
+const SystemMembershipDelta& ECSManager::GetMembershipDelta(const Signature& Old, const Signature& New)
+{
+    const auto key = std::make_pair(Old, New);
+    const auto cached = MembershipDeltaCache.find(key);
+
+    if (cached != MembershipDeltaCache.end())
+    {
+        return cached->second;
+    }
+
+    SystemMembershipDelta& delta = MembershipDeltaCache[key];
+
+    for (System* system : SystemOrder)
+    {
+        const Signature& systemSignature = system->GetComponentSignature();
+        const bool matchedOld = Old.Contains(systemSignature);
+        const bool matchesNew = New.Contains(systemSignature);
+
+        if (matchedOld && matchesNew == false)
+        {
+            delta.Removed.Systems.push_back(system);
+        }
+        else if (matchesNew && matchedOld == false)
+        {
+            delta.Added.Systems.push_back(system);
+        }
+    }
+
+    for (auto& [required, cache] : ViewCaches)
+    {
+        const bool matchedOld = Old.Contains(required);
+        const bool matchesNew = New.Contains(required);
+
+        if (matchedOld && matchesNew == false)
+        {
+            delta.Removed.Views.push_back(&cache);
+        }
+        else if (matchesNew && matchedOld == false)
+        {
+            delta.Added.Views.push_back(&cache);
+        }
+    }
+
+    return delta;
+}
+
+void ECSManager::InvalidateMembership()
+{
+    MembershipCache.clear();
+    MembershipDeltaCache.clear();
+}
+
+ViewCache& ECSManager::BuildViewCache(const Signature& Required)
+{
+    ViewCache& cache = ViewCaches[Required];
+    cache.Required = Required;
+
+    // Cached memberships don't know about the new view yet
+    InvalidateMembership();
+    MarkLayoutChanged();
+
+    if (StorageMode == EStorageMode::Archetype)
+    {
+        for (Archetype* archetype : ArchetypeList)
+        {
+            if (archetype->GetSignature().Contains(Required))
             {
-                system->RemoveEntity(InEntity);
+                for (unsigned int chunk = 0; chunk < archetype->GetNumChunks(); ++chunk)
+                {
+                    const unsigned int* entityIDs = archetype->GetEntityIDs(chunk);
+
+                    for (unsigned int row = 0; row < archetype->GetChunkCount(chunk); ++row)
+                    {
+                        if (DisabledComponents[entityIDs[row]].Intersects(Required) == false)
+                        {
+                            cache.EntityIDs.Insert(entityIDs[row]);
+                        }
+                    }
+                }
             }
-            else if ((systemSignature & New) == systemSignature)
+        }
+
+        return cache;
+    }
+
+    // Every match has to be in each of the required pools, so the smallest one bounds the scan.
+    // Tags have no pool to scan.
+    const std::vector<unsigned int>* candidates = nullptr;
+    const Signature stored = Required & ~TagComponents;
+
+    for (unsigned int componentID = stored.FindNext(0); componentID < Signature::NumBits; componentID = stored.FindNext(componentID + 1))
+    {
+        if (componentID >= ComponentPools.size() || ComponentPools[componentID] == nullptr)
+        {
+            // Nobody has this component yet, so nothing can match
+            return cache;
+        }
+
+        const auto& poolEntityIDs = ComponentPools[componentID]->GetEntityIDs();
+
+        if (candidates == nullptr || poolEntityIDs.size() < candidates->size())
+        {
+            candidates = &poolEntityIDs;
+        }
+    }
+
+    if (candidates != nullptr)
+    {
+        for (const unsigned int entityID : *candidates)
+        {
+            if (GetEnabledSignature(entityID).Contains(Required))
             {
-                system->AddEntity(InEntity);
+                cache.EntityIDs.Insert(entityID);
             }
         }
     }
+    else
+    {
+        // Nothing but tags, so every entity is a candidate
+        for (unsigned int entityID = 0; entityID < EntityComponentSignatures.size(); ++entityID)
+        {
+            if (GetEnabledSignature(entityID).Contains(Required))
+            {
+                cache.EntityIDs.Insert(entityID);
+            }
+        }
+    }
+
+    return cache;
 }
 
 void ECSManager::Update(const float DeltaTime)
 {
+    MakeActive();
+
+    PlaybackCommandBuffers();
+
     for (const Entity& entity : EntitiesToBeAdded)
     {
-        AddEntityToSystems(entity);
+        // Skip entities that were killed before they ever made it into a system
+        if (IsAlive(entity))
+        {
+            AddEntityToSystems(entity);
+        }
     }
     EntitiesToBeAdded.clear();
 
     for (const Entity& entity : EntitiesToBeRemoved)
     {
         RemoveEntityFromSystems(entity);
-        EntityComponentSignatures[entity.GetID()].reset();
+
+        Signature& signature = EntityComponentSignatures[entity.GetID()];
+
+        for (unsigned int componentID = signature.FindNext(0); componentID < Signature::NumBits; componentID = signature.FindNext(componentID + 1))
+        {
+            NotifyRemoved(componentID, entity);
+            SetDisabledBit(entity.GetID(), componentID, false);
+        }
+
+        signature.reset();
+
+        if (StorageMode == EStorageMode::Archetype)
+        {
+            RemoveEntityFromArchetype(entity.GetID());
+        }
+        else
+        {
+            for (IPool* pool : ComponentPools)
+            {
+                if (pool != nullptr)
+                {
+                    pool->Remove(entity.GetID());
+                }
+            }
+        }
+
+        FreeEntityIDs.push(entity.GetID());
     }
     EntitiesToBeRemoved.clear();
 
-    for (const auto& system : Systems)
+    DispatchObservers();
+
+    RunSystems(DeltaTime);
+}
+
+void ECSManager::Render(const float Alpha)
+{
+    MakeActive();
+
+    for (System* system : SystemOrder)
     {
-        system.second->Update(DeltaTime);
+        system->Render(Alpha);
     }
 }
+
+void ECSManager::BuildSystemGraph()
+{
+    const auto numSystems = SystemOrder.size();
+
+    SystemDependents.assign(numSystems, std::vector<unsigned int>());
+    SystemDependencyCounts.assign(numSystems, 0);
+
+    // Each system waits on every earlier system it conflicts with, so conflicting systems
+    // always run in the order they were added and everything else is free to overlap
+    for (unsigned int later = 0; later < numSystems; ++later)
+    {
+        for (unsigned int earlier = 0; earlier < later; ++earlier)
+        {
+            if (SystemOrder[later]->ConflictsWith(*SystemOrder[earlier]))
+            {
+                SystemDependents[earlier].push_back(later);
+                ++SystemDependencyCounts[later];
+            }
+        }
+    }
+
+    SystemGraphDirty = false;
+}
+
+void ECSManager::RunSystems(const float DeltaTime)
+{
+    JobSystem& jobSystem = JobSystem::Get();
+
+    if (ParallelUpdate == false || jobSystem.GetNumWorkers() == 0 || SystemOrder.size() < 2)
+    {
+        for (System* system : SystemOrder)
+        {
+            system->Update(DeltaTime);
+        }
+        return;
+    }
+
+    if (SystemGraphDirty)
+    {
+        BuildSystemGraph();
+    }
+
+    const auto numSystems = static_cast<unsigned int>(SystemOrder.size());
+
+    std::mutex scheduleMutex;
+    std::condition_variable scheduleChanged;
+    std::vector<unsigned int> waitingOn = SystemDependencyCounts;
+    std::vector<unsigned int> ready;
+    unsigned int numFinished = 0;
+
+    for (unsigned int idx = 0; idx < numSystems; ++idx)
+    {
+        if (waitingOn[idx] == 0)
+        {
+            ready.push_back(idx);
+        }
+    }
+
+    // Must be called with scheduleMutex held
+    const auto onFinished = [&](const unsigned int Idx)
+    {
+        for (const unsigned int dependent : SystemDependents[Idx])
+        {
+            if (--waitingOn[dependent] == 0)
+            {
+                ready.push_back(dependent);
+            }
+        }
+        ++numFinished;
+    };
+
+    std::unique_lock<std::mutex> lock(scheduleMutex);
+
+    // This thread does all of the dispatching. Workers only report back when they finish.
+    while (numFinished < numSystems)
+    {
+        if (ready.empty())
+        {
+            scheduleChanged.wait(lock);
+            continue;
+        }
+
+        const unsigned int idx = ready.front();
+        ready.erase(ready.begin());
+        System* system = SystemOrder[idx];
+
+        if (system->HasDeclaredAccess())
+        {
+            jobSystem.Submit([&, idx, system]()
+            {
+                system->Update(DeltaTime);
+
+                std::lock_guard<std::mutex> workerLock(scheduleMutex);
+                onFinished(idx);
+                scheduleChanged.notify_one();
+            });
+        }
+        else
+        {
+            // Systems with undeclared access run here, on the calling thread
+            lock.unlock();
+            system->Update(DeltaTime);
+            lock.lock();
+            onFinished(idx);
+        }
+    }
+}
+
+
+void ECSManager::NotifyWorldRestored()
+{
+    // Systems read components through the active manager
+    MakeActive();
+
+    for (System* system : SystemOrder)
+    {
+        system->OnWorldRestored();
+    }
+}
+
+void ECSManager::ResizeEntityStorage(const unsigned int EntityID)
+{
+    if (EntityID >= EntityComponentSignatures.size())
+    {
+        const auto newSize = (EntityID > 0) ? EntityID * 2 : 32;
+        EntityComponentSignatures.resize(newSize);
+        DisabledComponents.resize(newSize);
+        EntityGenerations.resize(newSize, 0);
+
+        if (StorageMode == EStorageMode::Archetype)
+        {
+            EntityLocations.resize(newSize);
+        }
+    }
+}
+
+Archetype* ECSManager::GetArchetypeEdge(Archetype* Source, const unsigned int ComponentID, const bool Add)
+{
+    if (Source == nullptr)
+    {
+        // Entities with no components don't live in an archetype, so there is no edge to cache
+        Signature signature;
+        return Add ? FindOrCreateArchetype(signature.set(ComponentID)) : nullptr;
+    }
+
+    Archetype*& edge = Add ? Source->AddEdge(ComponentID) : Source->RemoveEdge(ComponentID);
+
+    if (edge == nullptr)
+    {
+        Signature signature = Source->GetSignature();
+        signature.set(ComponentID, Add);
+
+        if (signature.none())
+        {
+            return nullptr;
+        }
+
+        edge = FindOrCreateArchetype(signature);
+    }
+
+    return edge;
+}
+
+Archetype* ECSManager::FindOrCreateArchetype(const Signature& InSignature)
+{
+    const auto archetypeItr = Archetypes.find(InSignature);
+
+    if (archetypeItr != Archetypes.end())
+    {
+        return archetypeItr->second;
+    }
+
+    Archetype* newArchetype = new Archetype(InSignature, ComponentInfos);
+    Archetypes[InSignature] = newArchetype;
+    ArchetypeList.push_back(newArchetype);
+
+    return newArchetype;
+}
+
+void ECSManager::MoveEntityToArchetype(const unsigned int EntityID, Archetype* Target)
+{
+    assert(Target != nullptr);
+
+    const EntityLocation source = EntityLocations[EntityID];
+    const EntityLocation destination = Target->AddRow(EntityID);
+    MarkLayoutChanged();
+
+    if (source.Owner != nullptr)
+    {
+        // Move every shared component over, anything only in Target is left for the caller to construct
+        const Signature shared = Target->GetSignature() & source.Owner->GetSignature();
+
+        for (unsigned int componentID = shared.FindNext(0); componentID < Signature::NumBits; componentID = shared.FindNext(componentID + 1))
+        {
+            ComponentInfos[componentID].MoveConstruct(
+                Target->GetComponent(componentID, destination.Chunk, destination.Row),
+                source.Owner->GetComponent(componentID, source.Chunk, source.Row)
+            );
+        }
+
+        RemoveEntityFromArchetype(EntityID);
+    }
+
+    EntityLocations[EntityID] = destination;
+}
+
+void ECSManager::RemoveEntityFromArchetype(const unsigned int EntityID)
+{
+    EntityLocation& location = EntityLocations[EntityID];
+
+    if (location.Owner != nullptr)
+    {
+        MarkLayoutChanged();
+
+        const auto movedID = location.Owner->RemoveRow(location.Chunk, location.Row);
+
+        // Another entity was moved into the removed row, so it now lives where we used to
+        if (movedID != Archetype::NullID)
+        {
+            EntityLocations[movedID] = location;
+        }
+
+        location = EntityLocation();
+    }
+}
+
+void ECSManager::SetDisabledBit(const unsigned int EntityID, const unsigned int ComponentID, const bool Disabled)
+{
+    if (DisabledComponents[EntityID].test(ComponentID) == Disabled)
+    {
+        return;
+    }
+
+    DisabledComponents[EntityID].set(ComponentID, Disabled);
+    MarkLayoutChanged();
+
+    NumDisabled[ComponentID] += Disabled ? 1 : -1;
+    DisabledTypes.set(ComponentID, NumDisabled[ComponentID] > 0);
+}
+
+void ECSManager::EraseComponent(const unsigned int EntityID, const unsigned int ComponentID)
+{
+    if (StorageMode == EStorageMode::Archetype)
+    {
+        Archetype* target = GetArchetypeEdge(EntityLocations[EntityID].Owner, ComponentID, false);
+
+        if (target != nullptr)
+        {
+            MoveEntityToArchetype(EntityID, target);
+        }
+        else
+        {
+            // That was the entity's last component
+            RemoveEntityFromArchetype(EntityID);
+        }
+    }
+    else if (ComponentID < ComponentPools.size() && ComponentPools[ComponentID] != nullptr)
+    {
+        ComponentPools[ComponentID]->Remove(EntityID);
+    }
+}
+
+CommandBuffer& ECSManager::GetCommandBuffer()
+{
+    std::lock_guard<std::mutex> lock(CommandBufferMutex);
+
+    std::unique_ptr<CommandBuffer>& buffer = CommandBuffers[std::this_thread::get_id()];
+
+    if (buffer == nullptr)
+    {
+        buffer = std::make_unique<CommandBuffer>(this);
+        CommandBufferOrder.push_back(buffer.get());
+    }
+
+    return *buffer;
+}
+
+void ECSManager::PlaybackCommandBuffers()
+{
+    std::lock_guard<std::mutex> lock(CommandBufferMutex);
+
+    std::vector<CommandBuffer*> buffers;
+
+    for (CommandBuffer* buffer : CommandBufferOrder)
+    {
+        if (buffer->Empty() == false)
+        {
+            buffers.push_back(buffer);
+        }
+    }
+
+    if (buffers.empty())
+    {
+        return;
+    }
+
+    for (CommandBuffer* buffer : buffers)
+    {
+        for (const Entity& entity : buffer->Created)
+        {
+            RegisterEntity(entity);
+        }
+    }
+
+    // One component type at a time across every buffer, so each pool grows at most once
+    for (unsigned int componentID = 0; componentID < CoreStatics::MaxNumComponentTypes; ++componentID)
+    {
+        IComponentCommandList* first = nullptr;
+        unsigned int numAdds = 0;
+
+        for (CommandBuffer* buffer : buffers)
+        {
+            if (componentID < buffer->ComponentCommands.size() && buffer->ComponentCommands[componentID] != nullptr)
+            {
+                first = (first != nullptr) ? first : buffer->ComponentCommands[componentID].get();
+                numAdds += buffer->ComponentCommands[componentID]->NumAdds();
+            }
+        }
+
+        if (first == nullptr)
+        {
+            continue;
+        }
+
+        if (numAdds > 0)
+        {
+            first->Reserve(*this, numAdds);
+        }
+
+        for (CommandBuffer* buffer : buffers)
+        {
+            if (componentID < buffer->ComponentCommands.size() && buffer->ComponentCommands[componentID] != nullptr)
+            {
+                buffer->ComponentCommands[componentID]->Playback(*this);
+            }
+        }
+    }
+
+    // Systems and views only see each entity's final signature
+    for (size_t i = 0; i < PlaybackEntities.size(); ++i)
+    {
+        const Entity& entity = PlaybackEntities[i];
+        UpdateEntityInSystems(entity, PlaybackOldSignatures[i], GetEnabledSignature(entity.GetID()));
+    }
+
+    PlaybackTouched.Clear();
+    PlaybackEntities.clear();
+    PlaybackOldSignatures.clear();
+
+    for (CommandBuffer* buffer : buffers)
+    {
+        for (const Entity& entity : buffer->Killed)
+        {
+            DestroyEntity(entity);
+        }
+
+        buffer->Clear();
+    }
+}
+
+void ECSManager::TouchForPlayback(const Entity InEntity)
+{
+    if (PlaybackTouched.Contains(InEntity.GetID()) == false)
+    {
+        PlaybackTouched.Insert(InEntity.GetID());
+        PlaybackEntities.push_back(InEntity);
+        PlaybackOldSignatures.push_back(GetEnabledSignature(InEntity.GetID()));
+    }
+}
+
+void ECSManager::ResizeChangeStorage(const unsigned int ComponentID, const unsigned int EntityID)
+{
+    std::vector<unsigned int>& versions = ComponentVersions[ComponentID];
+
+    if (EntityID >= versions.size())
+    {
+        versions.resize(std::max(EntityComponentSignatures.size(), static_cast<size_t>(EntityID) + 1), 0);
+    }
+}
+
+ViewCache& ECSManager::GetViewCache(const Signature& Required)
+{
+    std::lock_guard<std::mutex> lock(ViewCacheMutex);
+
+    const auto cacheItr = ViewCaches.find(Required);
+    return (cacheItr != ViewCaches.end()) ? cacheItr->second : BuildViewCache(Required);
+}
+
+void ECSManager::CollectChanged(const unsigned int ComponentID, unsigned int& LastVersion, std::vector<Entity>& Out)
+{
+    const unsigned int since = LastVersion;
+
+    // Anything written after this call stamps a higher version than the caller now holds
+    LastVersion = ChangeVersion.fetch_add(1);
+
+    // Nothing of this type has been touched, skip looking at the log at all (the common case for static things)
+    if (ComponentTypeVersions[ComponentID] <= since)
+    {
+        return;
+    }
+
+    const std::vector<ChangeRecord>& changeLog = ChangeLogs[ComponentID];
+    const std::vector<unsigned int>& versions = ComponentVersions[ComponentID];
+
+    // Records are in version order, so everything stamped since is at the end however many static entities came before
+    auto record = std::upper_bound(changeLog.begin(), changeLog.end(), since, 
+        [](const unsigned int Version, const ChangeRecord& Record) { return Version < Record.Version; });
+
+    for (; record != changeLog.end(); ++record)
+    {
+        const unsigned int entityID = record->EntityID;
+
+        // Only the entity's latest stamp counts, and only while it still has the component enabled
+        if (versions[entityID] == record->Version && GetEnabledSignature(entityID).test(ComponentID))
+        {
+            Out.push_back(Entity(entityID, EntityGenerations[entityID]));
+        }
+    }
+}
+
+void ECSManager::CompactChangeLog(const unsigned int ComponentID)
+{
+    std::vector<ChangeRecord>& changeLog = ChangeLogs[ComponentID];
+    const std::vector<unsigned int>& versions = ComponentVersions[ComponentID];
+
+    changeLog.erase(std::remove_if(changeLog.begin(), changeLog.end(), [&versions](const ChangeRecord& Record)
+    {
+        return versions[Record.EntityID] != Record.Version;
+    }), changeLog.end());
+
+    // Mostly still current, grow instead so the log isn't compacted again after only a few more stamps
+    if (changeLog.size() > changeLog.capacity() / 2)
+    {
+        changeLog.reserve(std::max(changeLog.capacity() * 2, static_cast<size_t>(64)));
+    }
+}
+
+void ECSManager::DispatchObservers()
+{
+    std::vector<Entity> batch;
+
+    for (unsigned int componentID = 0; componentID < CoreStatics::MaxNumComponentTypes; ++componentID)
+    {
+        ComponentObservers& observers = Observers[componentID];
+
+        // Observers may add and remove components themselves, those go in the next batch
+        if (observers.Removed.empty() == false)
+        {
+            MarkLayoutChanged();
+            batch.clear();
+            batch.swap(observers.Removed);
+
+            for (const ComponentObserver& observer : observers.OnRemove)
+            {
+                observer(batch);
+            }
+        }
+
+        if (observers.Added.empty() == false)
+        {
+            MarkLayoutChanged();
+            batch.clear();
+            batch.swap(observers.Added);
+
+            batch.erase(std::remove_if(batch.begin(), batch.end(), [this, componentID](const Entity& InEntity)
+            {
+                return IsAlive(InEntity) == false || EntityComponentSignatures[InEntity.GetID()].test(componentID) == false;
+            }), batch.end());
+
+            for (size_t i = 0; i < observers.OnAdd.size() && batch.empty() == false; ++i)
+            {
+                observers.OnAdd[i](batch);
+            }
+        }
+
+        if (observers.OnChange.empty() == false)
+        {
+            batch.clear();
+            CollectChanged(componentID, observers.ChangeVersion, batch);
+
+            if (batch.empty() == false)
+            {
+                for (const ComponentObserver& observer : observers.OnChange)
+                {
+                    observer(batch);
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
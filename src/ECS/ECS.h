@@ -7,38 +7,70 @@
 
 #include "Logger/Logger.h"
 #include "Util/CoreStatics.h"
+#include "Util/JobSystem.h"
+#include "Util/PageArena.h"
+#include "SparseSet.h"
+#include "Signature.h"
+#include "Archetype.h"
+#include "ComponentRegistry.h"
+#include "Snapshot.h"
+#include "Rollback.h"
 #include <vector>
 #include <cassert>
 #include <unordered_map>
 #include <typeindex>
-#include <set>
-#include <bitset>
 #include <unordered_set>
 #include <queue>
-
-typedef std::bitset<CoreStatics::MaxNumComponentTypes> Signature;
+#include <tuple>
+#include <mutex>
+#include <algorithm>
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <functional>
 
 /**
  * Entity class. Basically just an ID.
  * We will generally pass around COPIES of this class to store rather than pointers, since
  * the class itself is just a wrapper around plain old data and it wouldn't be meaningfully
  * more efficient to allocate a pointer or reference to it.
- * Holds the current number of entities as well as the max number (32)
- * which also serves as the NullID.
+ * 
+ * The handle packs the entity's index (its ID, used to look up components and signatures)
+ * in the low bits and a generation counter in the high bits. Destroying an entity bumps 
+ * the generation of its index, so stale copies of the handle stop comparing equal to (and 
+ * being alive as) whichever entity reuses the index later.
+ * 
+ * The component helpers below forward to the active ECSManager (see ECSManager::GetActive).
  */
 class Entity
 {
 public:
-    Entity(class ECSManager* Owner = nullptr);
+    static constexpr unsigned int IndexBits = CoreStatics::EntityIndexBits;
+    static constexpr unsigned int GenerationBits = 32 - IndexBits;
+    static constexpr unsigned int IndexMask = (1u << IndexBits) - 1;
+    static constexpr unsigned int GenerationMask = (1u << GenerationBits) - 1;
+    static constexpr unsigned int NullHandle = static_cast<unsigned int>(-1);
+
+    Entity() = default;
+    Entity(const unsigned int Index, const unsigned int Generation) 
+        : Handle(((Generation & GenerationMask) << IndexBits) | (Index & IndexMask)) {}
 
-    const unsigned int GetID() const { return EntityID; }
+    const unsigned int GetID() const { return Handle & IndexMask; }
+    const unsigned int GetGeneration() const { return Handle >> IndexBits; }
+    const unsigned int GetHandle() const { return Handle; }
+    const bool IsNull() const { return Handle == NullHandle; }
+
+    /** O(1) check that this handle has not been killed (and its index recycled) since it was created */
+    const bool IsAlive() const;
 
     void Kill() const;
 
     Entity& operator =(const Entity& Other) = default;
-    bool operator==(const Entity& Other) const { return EntityID == Other.GetID(); }
-    bool operator<(const Entity& Other) const { return EntityID < Other.GetID(); }
-    bool operator>(const Entity& Other) const { return EntityID > Other.GetID(); }
+    bool operator==(const Entity& Other) const { return Handle == Other.Handle; }
+    bool operator!=(const Entity& Other) const { return Handle != Other.Handle; }
+    bool operator<(const Entity& Other) const { return Handle < Other.Handle; }
+    bool operator>(const Entity& Other) const { return Handle > Other.Handle; }
 
     /**
      * Optional params are forwarded to the constructor of TComponent.
@@ -55,80 +87,149 @@ public:
     template <typename TComponent>
     TComponent& GetComponent() const;
 
-protected:
-    static unsigned int NumEntities; // = 0;
+    template <typename TComponent>
+    void SetComponentEnabled(const bool Enabled);
+
+    template <typename TComponent>
+    const bool IsComponentEnabled() const;
 
 private:
-    unsigned int EntityID = 0;
-    ECSManager* Owner = nullptr;
+    unsigned int Handle = NullHandle;
 };
 
-/**
- * Interface for all components that just keeps track of the current
- * NumComponentTypes to be assigned out as IDs. 
- * 
- * Possible TODO: data structure note above
- */
-class IComponent
-{
-protected:
-    static unsigned int NumComponentTypes; // = 0;
-};
+static_assert(sizeof(Entity) == 4, "Entity handles should stay a single 32-bit word");
+
+static_assert(TypeListSize<ComponentTypes>::value <= CoreStatics::MaxNumComponentTypes, 
+    "More component types than a Signature has bits, raise CoreStatics::MaxNumComponentTypes");
 
 /**
  * Component with a specific ID
- * NumComponents must live in IComponent because Component are templates.
- * 
- * This is why we have to have this weird GetID declaration of the ComponentID
- * for each template TComponent. Putting the ID assignment in the constructor
- * throws unresolved external symbol.
  * 
  * We need template Components in order that each type can naively have an ID
  * (whereas we don't need to do this for entities since there are not multiple
  * types of Entities, or for Systems because we do not need a System ID)
  * 
- * Can't use a type_index map like Systems because we are currently using the ComponentID
- * as a bitset in the signature. Refactoring the whole ECS framework to use an unlimited
- * number of components by having a signature as a data structure rather than a single
- * data type may allow for revisiting all of this in the future.
+ * The ID is TComponent's index in ComponentTypes (see ComponentRegistry.h), worked out at
+ * compile time - so it is the same in every run and build, safe to ask for from any thread,
+ * and free to look up on hot paths.
  */
- template <typename TComponent>
-class Component : IComponent
+template <typename TComponent>
+class Component
 {
 public:
-    Component() 
+    static constexpr unsigned int GetID()
     {
-        assert(NumComponentTypes + 1 < CoreStatics::MaxNumComponentTypes); 
-    }
+        constexpr unsigned int componentID = TypeListIndex<TComponent, ComponentTypes>::value;
+        static_assert(componentID < TypeListSize<ComponentTypes>::value, "Component type missing from ComponentTypes in ComponentRegistry.h");
 
-    static unsigned int GetID()
-    { 
-        static auto ComponentID = NumComponentTypes++;
-        return ComponentID;
+        return componentID;
     }
 };
 
+/**
+ * Tag components are empty types (e.g. class IsEnemy : public Component<IsEnemy> {}, listed
+ * in ComponentTypes like any other component).
+ * Having one only sets its bit in the entity's signature: no pool or archetype column
+ * bytes are ever allocated for it, and GetComponent hands back a shared instance.
+ */
+template <typename TComponent>
+constexpr bool IsTagComponent = std::is_empty_v<TComponent>;
+
 /**
  * A system to handle a specific component signature
+ * 
+ * Systems that declare their component access (ReadsComponent/WritesComponent) may be run
+ * by ECSManager::Update on worker threads, at the same time as any other system whose 
+ * access does not conflict with theirs. Systems that declare nothing are treated as 
+ * touching everything: they run alone, on the thread that called ECSManager::Update.
  */
 class System
 {
 public:
+    virtual ~System() = default;
+
     virtual void AddEntity(const Entity EntityToAdd);
+
+    /** Adds a whole batch of entities at once, see ECSManager::CreateEntities */
+    virtual void AddEntities(const std::vector<Entity>& EntitiesToAdd);
+
+    /** Swaps the last entity into EntityToRemove's slot, so GetEntities() order is not kept */
     void RemoveEntity(const Entity EntityToRemove);
 
+    const bool HasEntity(const Entity InEntity) const { return EntityIDs.Contains(InEntity.GetID()); }
+
     std::vector<Entity>& GetEntities() { return Entities; }
     const Signature& GetComponentSignature() const { return ComponentSignature; }
 
+    const Signature& GetReadSignature() const { return ReadSignature; }
+    const Signature& GetWriteSignature() const { return WriteSignature; }
+    const bool HasDeclaredAccess() const { return AccessDeclared; }
+
+    /** Whether running this and Other at the same time could race on component data */
+    const bool ConflictsWith(const System& Other) const;
+
+    /** The ECSManager this system was added to */
+    class ECSManager* GetOwner() const { return Owner; }
+
     virtual void Update(const float DeltaTime) = 0;
 
+    /**
+     * Called once per rendered frame by ECSManager::Render, after that frame's Update ticks.
+     * Alpha (0-1) is how far the frame is between the previous tick and the latest one, for 
+     * interpolating what is drawn.
+     */
+    virtual void Render(const float /*Alpha*/) {}
+
+    /**
+     * Called once ECSManager::RestoreFrame or LoadSnapshot has replaced the world, before the next
+     * Update. Systems that keep their own state derived from the world rebuild it here from the 
+     * world as it now is, so the next Update carries on as if it followed the restored frame.
+     */
+    virtual void OnWorldRestored() {}
+
+    /**
+     * Calls Fn(const Entity&) for every entity in GetEntities(), split into ranges of ChunkSize 
+     * entities that run across the job system's workers. Returns once every entity is done.
+     * Fn must only touch the components of the entity it is given.
+     */
+    template <typename TFunc>
+    void ParallelForEach(const size_t ChunkSize, TFunc&& Fn);
+
 protected:
     template <typename TComponent>
     void RequireComponent();
 
+    /** Declares that Update reads (but never writes) TComponent */
+    template <typename TComponent>
+    void ReadsComponent();
+
+    /** Declares that Update writes TComponent */
+    template <typename TComponent>
+    void WritesComponent();
+
+    /**
+     * Reorders Entities by Compare (a strict weak ordering on const Entity&), for systems that
+     * need their entities in order. Cheap when they are already sorted, so it is fine to call
+     * once per frame from Update.
+     */
+    template <typename TCompare>
+    void SortEntities(TCompare&& Compare);
+
     Signature ComponentSignature;
+    Signature ReadSignature;
+    Signature WriteSignature;
+    bool AccessDeclared = false;
+
+    /** 
+     * Entities packed densely, EntityIDs maps an entity ID to its index in Entities. 
+     * The two are always kept in step.
+     */
     std::vector<Entity> Entities;
-    std::unordered_set<unsigned int> EntityIDs;
+    SparseSet EntityIDs;
+
+private:
+    friend class ECSManager;
+    ECSManager* Owner = nullptr;
 };
 
 /**
@@ -138,296 +239,1773 @@ class IPool
 {
 public:
     virtual ~IPool() = default;
+
+    virtual const bool Contains(const unsigned int EntityID) const = 0;
+    virtual void Remove(const unsigned int EntityID) = 0;
+    virtual void Clear() = 0;
+    virtual const std::vector<unsigned int>& GetEntityIDs() const = 0;
+
+    /** Copies every component, sharing whatever is unchanged since Previous (this pool's last saved frame, or nullptr) */
+    virtual std::shared_ptr<const IPoolFrame> SaveFrame(const IPoolFrame* Previous) = 0;
+
+    /** Puts back exactly what SaveFrame copied: the same components, in the same slots and order */
+    virtual void RestoreFrame(const IPoolFrame& Frame) = 0;
 };
 
 /**
- * Pool of some object. Can be Entity, Component, etc.
+ * Sparse set pool of components. 
+ * Components live in fixed-size pages from the owning ECSManager's PageArena, Entities maps
+ * entity IDs to their index in Slots (and back) and Slots holds each one's slot in the pages.
+ * Memory scales with the number of components actually in the pool rather than with the 
+ * highest entity ID.
+ * 
+ * Pages are never moved or copied, and a component stays in its slot until it is removed, so
+ * references to it stay valid through any number of other adds and removes. Freed slots are 
+ * reused by later adds.
  */
 template <typename T>
 class Pool : public IPool
 {
 public:
-     Pool(const unsigned int size = 100) { Data.resize(size); }
-     virtual ~Pool() = default;
-
-     const bool Empty() const { return Data.empty(); }
-     const int Size() const { return Data.size(); }
-     void Resize(const unsigned int Size) { Data.resize(Size); }
-     void Clear() { Data.clear(); }
-     void Push(T Object) { Data.push_back(Object); }
-     void Insert(const int Idx, T& Object) { Data.insert(Data.begin() + Idx, Object); }
-     void Erase(const unsigned int Idx) { Data.erase(Idx); }
-     T& Get(const int Idx) { return Data[Idx]; }
-     void operator[](unsigned int Idx) { return Data[Idx]; }
+    static_assert(sizeof(T) <= CoreStatics::PoolPageSize, "Component too big for a pool page");
+    static_assert(alignof(T) <= PageArena::PageAlignment, "Component alignment too strict for a pool page");
 
-private:
-    std::vector<T> Data;
-};
+    /** Components per page. A compile-time constant, so finding a slot's page is still a multiply and shift. */
+    static constexpr unsigned int PageCapacity = CoreStatics::PoolPageSize / sizeof(T);
 
-/**
- * ECSManager singleton. Manages the life cycles of all ECS objects.
- * The data structures here represent the relationships between entities, components,
- * and systems (e.g. which entities have which components and signatures)
- */
-class ECSManager
-{
-public:
-    ECSManager() = default;
-    ~ECSManager();
+    Pool(PageArena& InArena) : Arena(InArena) {}
+    virtual ~Pool();
 
-    void Update(const float DeltaTime);
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
 
-    ////////////////////////////////////////////////////////////////////////////////
-    // Entity Management
+    const bool Empty() const { return Slots.empty(); }
+    const int Size() const { return static_cast<int>(Slots.size()); }
 
-    Entity CreateEntity();
-    void DestroyEntity(const Entity InEntity);
-    std::queue<unsigned int>& GetFreeEntityIDs() { return FreeEntityIDs; }
+    /** Makes sure Capacity components fit without allocating another page */
+    void Reserve(const unsigned int Capacity);
 
-    unsigned int NumEntities = 0;
+    /** Removes every component, handing the pages back to the arena */
+    void Clear() override;
 
-    ////////////////////////////////////////////////////////////////////////////////
-    // Component Management
+    const bool Contains(const unsigned int EntityID) const override { return Entities.Contains(EntityID); }
 
     /**
-     * Optional params after InEntity are forwarded to the constructor of TComponent.
-     * Make sure they are present and correct if TComponent's constructor
-     * does not have defaults!
+     * Constructs a component for EntityID in place, forwarding Args to its constructor.
+     * Overwrites the existing component if EntityID already has one.
      */
-    template <typename TComponent, typename ...TArgs>
-    void AddComponent(Entity InEntity, TArgs&& ...Args);
+    template <typename ...TArgs>
+    T& Emplace(const unsigned int EntityID, TArgs&& ...Args);
 
-    template <typename TComponent>
-    const bool HasComponent(const Entity InEntity) const;
-    
-    template <typename TComponent>
-    void RemoveComponent(Entity InEntity);
+    void Remove(const unsigned int EntityID) override;
 
-    template <typename TComponent>
-    TComponent& GetComponent(const Entity InEntity);
+    /**
+     * Empty pools of trivially copyable T only. Fills the pool with Count components for EntityIDs,
+     * copied a page at a time from Data: packed Ts, which need not be aligned (e.g. a mapped file).
+     */
+    void Adopt(const unsigned int* EntityIDs, const unsigned char* Data, const unsigned int Count);
 
-    ////////////////////////////////////////////////////////////////////////////////
-    // System Management
+    T& Get(const unsigned int EntityID) { return *SlotAt(Slots[Entities.IndexOf(EntityID)]); }
+    T& operator[](const unsigned int EntityID) { return Get(EntityID); }
+
+    const std::vector<unsigned int>& GetEntityIDs() const override { return Entities.GetDense(); }
 
     /**
-     * Optional params are forwarded to the constructor of TSystem.
+     * Trivially copyable T is saved a page at a time, sharing pages whose bytes have not changed.
+     * Anything else is copied component by component.
      */
-    template <typename TSystem, typename ...TArgs>
-    void AddSystem(TArgs&& ...Args);
+    std::shared_ptr<const IPoolFrame> SaveFrame(const IPoolFrame* Previous) override;
+    void RestoreFrame(const IPoolFrame& Frame) override;
 
-    template <typename TSystem>
-    void RemoveSystem();
+private:
+    struct PoolFrame : public IPoolFrame
+    {
+        std::shared_ptr<const PoolLayout> Layout;
 
-    template <typename TSystem>
-    const bool HasSystem() const;
+        /** Trivially copyable T only, the bytes of every slot handed out so far */
+        std::vector<FramePage> Pages;
 
-    template <typename TSystem>
-    TSystem* GetSystem() const;
+        /** Anything else, in the same order as Layout->EntityIDs */
+        std::vector<T> Components;
+    };
 
-private:
-    void AddEntityToSystems(const Entity InEntity);
-    void RemoveEntityFromSystems(const Entity InEntity);
-    void UpdateEntityInSystems(const Entity InEntity, const Signature& Old, const Signature& New);
+    T* SlotAt(const unsigned int Slot) const { return Pages[Slot / PageCapacity] + (Slot % PageCapacity); }
 
-    /**
-     * Index indicates ComponentID, value is that component's pool (of entities with that component)
-     */
-    std::vector<IPool*> ComponentPools;
+    /** A free slot, allocating a new page if every slot is taken */
+    unsigned int AllocateSlot();
 
-    /**
-     * Index indicates EntityID, value is that entity's signature
-     */
-    std::vector<Signature> EntityComponentSignatures;
+    std::vector<T*> Pages;
 
-    /**
-     * TODO: refactor to use vector, not sure this implementation makes sense
-     */
-     std::unordered_map<std::type_index, System*> Systems;
+    /** Slot of each component, in the same order as GetEntityIDs() */
+    std::vector<unsigned int> Slots;
 
-    /** 
-     * Entities flagged to be added or removed in the next Update() call 
-     */
-    std::set<Entity> EntitiesToBeAdded;
-    std::set<Entity> EntitiesToBeRemoved;
+    /** Slots freed by Remove, handed out again before any new ones */
+    std::vector<unsigned int> FreeSlots;
 
-    /**
-     * Entity IDs of destroyed entities that can now be reused
-     */
-     std::queue<unsigned int> FreeEntityIDs;
+    /** Slots handed out at least once so far, every one below this is either in Slots or FreeSlots */
+    unsigned int NumSlotsUsed = 0;
+
+    SparseSet Entities;
+    PageArena& Arena;
+
+    /** The layout as of the last SaveFrame/RestoreFrame, dropped as soon as a component is added or removed */
+    std::shared_ptr<const PoolLayout> SavedLayout;
 };
 
-template <typename TComponent, typename ...TArgs>
-void ECSManager::AddComponent(Entity InEntity, TArgs&& ...Args)
+template <typename T>
+Pool<T>::~Pool()
 {
-    const auto entityID = InEntity.GetID();
-    const auto componentID = Component<TComponent>::GetID();
+    Clear();
+}
 
-    // Bounds check on the array of pools, allocate nullptrs as needed
-    if (componentID >= ComponentPools.size())
+template <typename T>
+void Pool<T>::Reserve(const unsigned int Capacity)
+{
+    Slots.reserve(Capacity);
+    Entities.Reserve(Capacity);
+
+    while (Pages.size() * PageCapacity < Capacity)
     {
-        const auto newSize = (ComponentPools.size() > 0) ? ComponentPools.size() * 2 : 32;
-        ComponentPools.resize(newSize, nullptr);
+        Pages.push_back(static_cast<T*>(Arena.AllocatePage()));
     }
+}
 
-    // If we needed to add nullptrs, allocate a new Pool and store it
-    if (ComponentPools[componentID] == nullptr)
+template <typename T>
+void Pool<T>::Clear()
+{
+    for (const unsigned int slot : Slots)
     {
-        ComponentPools[componentID] = new Pool<TComponent>();
+        SlotAt(slot)->~T();
     }
 
-    Pool<TComponent>* componentPool = static_cast<Pool<TComponent>*>((ComponentPools[componentID]));
-
-    // Bounds check on this particular pool
-    if (entityID >= static_cast<unsigned int>(componentPool->Size())) // blah warning blah
+    for (T* page : Pages)
     {
-        if (entityID > 0)
-        {
-            componentPool->Resize(entityID * 2);
-        }
-        else
-        {
-            componentPool->Resize(32);
-        }
+        Arena.FreePage(page);
     }
 
-    // Make a new component to assign to the entity, forwarding constructor args if they are present
-    TComponent newComponent(std::forward<TArgs>(Args)...);
-
-    // Assign it to the entity (in this component type's pool, at this entity ID's index)
-    componentPool->Insert(entityID, newComponent);
+    Pages.clear();
+    Slots.clear();
+    FreeSlots.clear();
+    NumSlotsUsed = 0;
+    Entities.Clear();
+    SavedLayout.reset();
+}
 
-    if (entityID >= EntityComponentSignatures.size())
+template <typename T>
+unsigned int Pool<T>::AllocateSlot()
+{
+    if (FreeSlots.empty() == false)
     {
-        if (entityID > 0)
-        {
-            EntityComponentSignatures.resize(entityID * 2);
-        }
-        else
-        {
-            EntityComponentSignatures.resize(32);
-        }
+        const unsigned int slot = FreeSlots.back();
+        FreeSlots.pop_back();
+        return slot;
     }
 
-    // Capture the old signature
-    const Signature oldEntitySignature = EntityComponentSignatures[entityID];
-
-    // Update the entity's signature to indicate that this component is assigned to this entity
-    const Signature newEntitySignature = EntityComponentSignatures[entityID].set(componentID);
+    if (NumSlotsUsed == Pages.size() * PageCapacity)
+    {
+        Pages.push_back(static_cast<T*>(Arena.AllocatePage()));
+    }
 
-    UpdateEntityInSystems(InEntity, oldEntitySignature, newEntitySignature);
+    return NumSlotsUsed++;
 }
 
-template <typename TComponent>
-const bool ECSManager::HasComponent(const Entity InEntity) const
+template <typename T>
+template <typename ...TArgs>
+T& Pool<T>::Emplace(const unsigned int EntityID, TArgs&& ...Args)
 {
-    assert(InEntity.GetID() < EntityComponentSignatures.size());
-    return EntityComponentSignatures[InEntity.GetID()].test(Component<TComponent>::GetID());
-}
+    const auto idx = Entities.IndexOf(EntityID);
 
-template <typename TComponent>
-void ECSManager::RemoveComponent(Entity InEntity)
-{
-    assert(InEntity.GetID() < EntityComponentSignatures.size());
+    if (idx != SparseSet::NullIndex)
+    {
+        T& existing = *SlotAt(Slots[idx]);
+        existing = T(std::forward<TArgs>(Args)...);
+        return existing;
+    }
 
-    const auto entityID = InEntity.GetID();
-    const Signature oldSignature = EntityComponentSignatures[entityID];
-    const Signature newSignature = EntityComponentSignatures[entityID].set(Component<TComponent>::GetID(), false);
+    const unsigned int slot = AllocateSlot();
+    T* component = new (SlotAt(slot)) T(std::forward<TArgs>(Args)...);
 
-    UpdateEntityInSystems(InEntity, oldSignature, newSignature);
+    Entities.Insert(EntityID);
+    Slots.push_back(slot);
+    SavedLayout.reset();
+
+    return *component;
 }
 
-template <typename TComponent>
-TComponent& ECSManager::GetComponent(const Entity InEntity)
+template <typename T>
+void Pool<T>::Adopt(const unsigned int* EntityIDs, const unsigned char* Data, const unsigned int Count)
 {
-    assert(HasComponent<TComponent>(InEntity));
-    const auto entityId = InEntity.GetID();
-    const auto componentId = Component<TComponent>::GetID();
+    static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be adopted as bytes");
+    assert(Empty() && NumSlotsUsed == 0);
 
-    Pool<TComponent>* componentPool = static_cast<Pool<TComponent>*>((ComponentPools[componentId]));
+    Reserve(Count);
 
-    return componentPool->Get(entityId);
+    for (unsigned int first = 0; first < Count; first += PageCapacity)
+    {
+        const unsigned int numInPage = std::min(PageCapacity, Count - first);
+        std::memcpy(Pages[first / PageCapacity], Data + static_cast<size_t>(first) * sizeof(T), numInPage * sizeof(T));
+    }
+
+    for (unsigned int idx = 0; idx < Count; ++idx)
+    {
+        Entities.Insert(EntityIDs[idx]);
+        Slots.push_back(idx);
+    }
+
+    NumSlotsUsed = Count;
+    SavedLayout.reset();
 }
 
-template <typename TSystem, typename ...TArgs>
-void ECSManager::AddSystem(TArgs&& ...Args)
+template <typename T>
+void Pool<T>::Remove(const unsigned int EntityID)
 {
-    const auto systemIdx = std::type_index(typeid(TSystem));
+    const auto idx = Entities.Remove(EntityID);
 
-    if (Systems.count(systemIdx) == 0)
+    if (idx != SparseSet::NullIndex)
     {
-        Systems[systemIdx] = new TSystem(std::forward<TArgs>(Args)...);
+        const unsigned int slot = Slots[idx];
+        SlotAt(slot)->~T();
+        FreeSlots.push_back(slot);
+
+        // Mirror the swap-and-pop the sparse set just did. Only the slot numbers move, never the components.
+        Slots[idx] = Slots.back();
+        Slots.pop_back();
+        SavedLayout.reset();
     }
 }
 
-template <typename TSystem>
-void ECSManager::RemoveSystem()
+template <typename T>
+std::shared_ptr<const IPoolFrame> Pool<T>::SaveFrame(const IPoolFrame* Previous)
 {
-    const auto systemIdx = std::type_index(typeid(TSystem));
-    
-    if (Systems.count(systemIdx))
+    static_assert(std::is_copy_constructible_v<T>, "Components must be copyable to be saved in a frame");
+
+    const auto* previous = static_cast<const PoolFrame*>(Previous);
+    auto frame = std::make_shared<PoolFrame>();
+
+    if (SavedLayout == nullptr)
     {
-        Systems.erase(systemIdx);
+        SavedLayout = std::make_shared<const PoolLayout>(PoolLayout{ Entities.GetDense(), Slots, FreeSlots, NumSlotsUsed });
     }
-}
 
-template <typename TSystem>
-const bool ECSManager::HasSystem() const
-{
-    const auto systemIdx = std::type_index(typeid(TSystem));
-    return Systems.count(systemIdx);
-}
+    frame->Layout = SavedLayout;
 
-template <typename TSystem>
-TSystem* ECSManager::GetSystem() const
-{
-    const auto systemIdx = std::type_index(typeid(TSystem));
-    const auto systemItr = Systems.find(systemIdx);
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        frame->Pages.reserve(Pages.size());
 
-    if (systemItr != Systems.end())
+        // Only slots below NumSlotsUsed have ever held anything
+        for (unsigned int first = 0; first < NumSlotsUsed; first += PageCapacity)
+        {
+            const auto page = first / PageCapacity;
+            const size_t numBytes = std::min(PageCapacity, NumSlotsUsed - first) * sizeof(T);
+            const FramePage* previousPage = (previous != nullptr && page < previous->Pages.size()) ? &previous->Pages[page] : nullptr;
+
+            frame->Pages.push_back(FramePage::Capture(Pages[page], numBytes, previousPage));
+        }
+    }
+    else
     {
-        const auto& pair = *systemItr;
+        frame->Components.reserve(Slots.size());
 
-        if (pair.second != nullptr)
+        for (const unsigned int slot : Slots)
         {
-            return static_cast<TSystem*>(pair.second);
+            frame->Components.push_back(*SlotAt(slot));
         }
     }
-    
-    return nullptr;
-}
 
-template <typename TComponent>
-void System::RequireComponent()
-{
-    ComponentSignature.set(Component<TComponent>::GetID());
+    return frame;
 }
 
-
-template <typename TComponent, typename ...TArgs>
-void Entity::AddComponent(TArgs&& ...Args)
+template <typename T>
+void Pool<T>::RestoreFrame(const IPoolFrame& Frame)
 {
-    assert(Owner != nullptr);
-    Owner->AddComponent<TComponent>(*this, std::forward<TArgs>(Args)...);
+    const auto& frame = static_cast<const PoolFrame&>(Frame);
 
-}
-
-template <typename TComponent>
-void Entity::RemoveComponent()
-{
-    assert(Owner != nullptr);
-    Owner->RemoveComponent<TComponent>(*this);
-}
+    if constexpr (std::is_trivially_copyable_v<T> == false)
+    {
+        for (const unsigned int slot : Slots)
+        {
+            SlotAt(slot)->~T();
+        }
+    }
 
-template <typename TComponent>
-const bool Entity::HasComponent() const
-{
-    assert(Owner != nullptr);
-    return Owner->HasComponent<TComponent>(*this);
-}
+    // Nothing was added or removed since the frame was saved (or last restored), so the slots already match
+    if (frame.Layout != SavedLayout)
+    {
+        Entities.Assign(frame.Layout->EntityIDs);
+        Slots = frame.Layout->Slots;
+        FreeSlots = frame.Layout->FreeSlots;
+        NumSlotsUsed = frame.Layout->NumSlotsUsed;
+        SavedLayout = frame.Layout;
 
-template <typename TComponent>
+        while (Pages.size() * PageCapacity < NumSlotsUsed)
+        {
+            Pages.push_back(static_cast<T*>(Arena.AllocatePage()));
+        }
+    }
+
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        for (size_t page = 0; page < frame.Pages.size(); ++page)
+        {
+            std::memcpy(Pages[page], frame.Pages[page].Bytes.get(), frame.Pages[page].Size);
+        }
+    }
+    else
+    {
+        for (size_t idx = 0; idx < Slots.size(); ++idx)
+        {
+            new (SlotAt(Slots[idx])) T(frame.Components[idx]);
+        }
+    }
+}
+
+/**
+ * How an ECSManager stores its components.
+ * SparseSet keeps one packed Pool per component type - cheap to add and remove components.
+ * Archetype groups entities with identical signatures into chunks with one column per
+ * component type - cheap to iterate many components together (see ForEachChunk).
+ */
+enum class EStorageMode
+{
+    SparseSet = 0,
+    Archetype,
+};
+
+/**
+ * Cached join for a View: the IDs of every entity whose signature contains Required.
+ * ECSManager keeps one per distinct set of viewed components and updates it incrementally
+ * whenever an entity's signature changes, so a View never has to rescan every entity.
+ */
+struct ViewCache
+{
+    Signature Required;
+    SparseSet EntityIDs;
+};
+
+/**
+ * The systems and view caches whose required components are all in some signature.
+ */
+struct SystemMembership
+{
+    std::vector<System*> Systems;
+    std::vector<ViewCache*> Views;
+};
+
+/**
+ * The systems and view caches an entity joins and leaves when its signature changes.
+ */
+struct SystemMembershipDelta
+{
+    SystemMembership Added;
+    SystemMembership Removed;
+};
+
+/** Called with a batch of entities, see ECSManager::OnAdd */
+typedef std::function<void(const std::vector<Entity>&)> ComponentObserver;
+
+/**
+ * Everything observing one component type, and the entities waiting to be handed to them.
+ */
+struct ComponentObservers
+{
+    std::vector<ComponentObserver> OnAdd;
+    std::vector<ComponentObserver> OnRemove;
+    std::vector<ComponentObserver> OnChange;
+
+    std::vector<Entity> Added;
+    std::vector<Entity> Removed;
+
+    /** Change version OnChange observers were last dispatched at */
+    unsigned int ChangeVersion = 0;
+};
+
+/** EntityID's component was stamped as written at Version, see ECSManager::StampChange */
+struct ChangeRecord
+{
+    unsigned int EntityID;
+    unsigned int Version;
+};
+
+template <typename ...TComponents>
+class ComponentView;
+
+/** How to save and load one component type, see ECSManager::SaveSnapshot */
+struct ComponentSnapshotOps;
+
+template <typename TComponent>
+class ComponentCommandList;
+
+class CommandBuffer;
+
+/**
+ * ECSManager singleton. Manages the life cycles of all ECS objects.
+ * The data structures here represent the relationships between entities, components,
+ * and systems (e.g. which entities have which components and signatures)
+ */
+class ECSManager
+{
+public:
+    ECSManager(const EStorageMode Mode = EStorageMode::SparseSet);
+    ~ECSManager();
+
+    const EStorageMode GetStorageMode() const { return StorageMode; }
+
+    /**
+     * Flushes pending entity changes, then runs every system. Systems run in the order they
+     * were added unless their declared access lets them overlap (see System).
+     */
+    void Update(const float DeltaTime);
+
+    /** Calls Render(Alpha) on every system in the order they were added, on the calling thread */
+    void Render(const float Alpha);
+
+    /**
+     * Set false to run every system one after another on the calling thread, in the order they
+     * were added. Updates are then fully deterministic (as long as the systems are), which
+     * re-simulating after RestoreFrame relies on.
+     */
+    void SetParallelUpdate(const bool Enabled) { ParallelUpdate = Enabled; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Entity Management
+
+    Entity CreateEntity();
+
+    /**
+     * Creates Count entities that each start with a copy of every component in Prototype, e.g.
+     * CreateEntities(NumTiles, TransformComponent(), SpriteComponent("Tilemap"))
+     * IDs, entity storage and pool capacity are reserved once for the whole batch, and the new
+     * entities join their systems straight away in a single pass rather than once per component.
+     */
+    template <typename ...TComponents>
+    std::vector<Entity> CreateEntities(const unsigned int Count, const TComponents& ...Prototype);
+
+    /** Kills InEntity immediately (IsAlive turns false), its components are freed on the next Update() */
+    void DestroyEntity(const Entity InEntity);
+
+    const bool IsAlive(const Entity InEntity) const;
+
+    unsigned int NumEntities = 0;
+
+    /**
+     * The manager Entity's component helpers forward to. The first ECSManager constructed
+     * becomes active, and each manager makes itself active for the duration of its Update().
+     */
+    static ECSManager* GetActive() { return Active; }
+    void MakeActive() { Active = this; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Component Management
+
+    /**
+     * Optional params after InEntity are forwarded to the constructor of TComponent.
+     * Make sure they are present and correct if TComponent's constructor
+     * does not have defaults!
+     */
+    template <typename TComponent, typename ...TArgs>
+    void AddComponent(Entity InEntity, TArgs&& ...Args);
+
+    template <typename TComponent>
+    const bool HasComponent(const Entity InEntity) const;
+    
+    template <typename TComponent>
+    void RemoveComponent(Entity InEntity);
+
+    template <typename TComponent>
+    TComponent& GetComponent(const Entity InEntity);
+
+    /**
+     * Disabling a component keeps it (and its data) on InEntity, but systems and views treat the
+     * entity as if it did not have it until it is enabled again. Toggling is cheap: nothing is
+     * moved in storage and only the systems and views that require TComponent are touched.
+     * HasComponent still returns true for disabled components. Removing a component and adding
+     * it back enables it again.
+     */
+    template <typename TComponent>
+    void SetComponentEnabled(const Entity InEntity, const bool Enabled);
+
+    template <typename TComponent>
+    const bool IsComponentEnabled(const Entity InEntity) const;
+
+    /** 
+     * Packed pool of every TComponent, or nullptr if none have been added yet.
+     * Always nullptr with archetype storage, and for tag components.
+     */
+    template <typename TComponent>
+    Pool<TComponent>* GetComponentPool() const;
+
+    /**
+     * Archetype storage only. Calls Fn(Count, TComponents*...) once for every chunk of every
+     * archetype that has all of TComponents, each pointer being the start of that chunk's 
+     * column of Count components.
+     */
+    template <typename ...TComponents, typename TFunc>
+    void ForEachChunk(TFunc&& Fn);
+
+    /**
+     * Ad-hoc query for every entity that has all of TComponents, e.g.
+     * View<TransformComponent, RigidBodyComponent>().Each([](TransformComponent& T, RigidBodyComponent& R) {...});
+     * The first View of a given set of components builds its cache from the smallest of their
+     * pools, later ones reuse it. Entities with any of TComponents disabled are left out.
+     */
+    template <typename ...TComponents>
+    ComponentView<TComponents...> View();
+
+    /** Shorthand for View<TComponents...>().Each(Fn) */
+    template <typename ...TComponents, typename TFunc>
+    void Each(TFunc&& Fn);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Change Tracking
+
+    /**
+     * Every entity whose TComponent was added or written since LastVersion, e.g.
+     * for (const Entity& entity : ViewChanged<TransformComponent>(LastSeenVersion)) {...}
+     * Start LastVersion at 0 to get every entity the first time. It is advanced on each call, 
+     * so the next call only returns changes made after this one.
+     * 
+     * Components are stamped as written when added, when a view's Each/ParallelEach hands them to 
+     * Fn by non-const reference, and by MarkChanged. Writes through GetComponent are not seen 
+     * unless followed by MarkChanged. Costs only as much as the entities stamped since LastVersion, 
+     * however many unchanged ones there are.
+     */
+    template <typename TComponent>
+    std::vector<Entity> ViewChanged(unsigned int& LastVersion);
+
+    /** Stamps InEntity's TComponent as written. Not from inside ParallelEach, stamps are logged unlocked. */
+    template <typename TComponent>
+    void MarkChanged(const Entity InEntity);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    /**
+     * Fn is called with every entity that gained TComponent since the last call, once per Update()
+     * (after pending entity changes are flushed, before systems run) rather than on every 
+     * AddComponent. Entities that lost it again or died in the meantime are left out.
+     * Entities that already had TComponent when Fn was registered are not reported.
+     */
+    template <typename TComponent>
+    void OnAdd(ComponentObserver Fn);
+
+    /**
+     * Like OnAdd, for entities that lost TComponent (including by being destroyed). The component
+     * is already gone when Fn runs and the handle may be dead - use it as a key, e.g. to drop 
+     * the entity from a cache.
+     */
+    template <typename TComponent>
+    void OnRemove(ComponentObserver Fn);
+
+    /**
+     * Like OnAdd, for entities whose TComponent was written since the last call (newly added 
+     * ones included). Writes are detected the same way as for ViewChanged.
+     */
+    template <typename TComponent>
+    void OnChange(ComponentObserver Fn);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Snapshots
+
+    /**
+     * Writes every live entity and its components to Path in a versioned binary format.
+     * Trivially copyable components are written as raw blocks, anything else must have
+     * void Serialize(SnapshotWriter&) const and void Deserialize(SnapshotReader&).
+     * Call between Updates: commands still waiting in command buffers are not saved.
+     */
+    const bool SaveSnapshot(const std::string& Path);
+
+    /**
+     * Replaces every entity with the ones saved at Path, keeping their IDs and generations, and
+     * puts them in their systems and views. The file is memory-mapped and raw component blocks
+     * are copied straight into storage. Observers are not told about any of it, systems are
+     * through System::OnWorldRestored.
+     * Returns false (leaving the world untouched) if the file is missing or not a valid snapshot.
+     */
+    const bool LoadSnapshot(const std::string& Path);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Rollback
+
+    /**
+     * How many frames SaveFrame keeps (CoreStatics::NumRollbackFrames by default), for rolling
+     * back and re-simulating. Drops every frame saved so far.
+     */
+    void SetRollbackFrames(const unsigned int NumFrames);
+
+    /**
+     * Saves the whole world in memory as Frame, in place of the frame saved NumFrames ago.
+     * Only what changed since the last frame saved (or restored) is copied, everything else is 
+     * shared with it: trivially copyable components are compared and copied a page at a time,
+     * other components are copied one by one, and entity signatures and system membership only
+     * when some entity was created, destroyed or gained, lost or toggled a component.
+     * Plays back every command buffer first, as the next Update would. Call between Updates.
+     */
+    void SaveFrame(const unsigned int Frame);
+
+    /**
+     * Puts every entity, component, system and view back exactly as it was when Frame was saved,
+     * down to iteration order, so running the same Updates again gives the same result.
+     * Commands still in command buffers are thrown away and observers are not told, systems
+     * rebuild their own state in System::OnWorldRestored. Change versions keep counting up.
+     * Frames saved after Frame are kept.
+     * Returns false if Frame was never saved or has since been overwritten.
+     */
+    const bool RestoreFrame(const unsigned int Frame);
+
+    /**
+     * Times SaveFrame and RestoreFrame on a world of its own, NumEntities entities with a transform
+     * and rigid body that all move every frame, Iterations frames over. Each frame is saved, then
+     * the one before it restored. Leaves the active ECSManager as it was.
+     */
+    static RollbackBenchmark BenchmarkRollback(const unsigned int NumEntities, const unsigned int Iterations);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Deferred Commands
+
+    /**
+     * The calling thread's command buffer. Record entity/component changes into it from
+     * worker threads or while iterating a view, rather than calling the methods above.
+     */
+    CommandBuffer& GetCommandBuffer();
+
+    /**
+     * Applies every thread's recorded commands, batched by component type: first all created
+     * entities, then each component type's adds and removes (in ascending component ID, 
+     * recorded order within a type), then all kills. Buffers are always taken in the order
+     * their threads first asked for one. Systems and views are updated once
+     * per changed entity at the end rather than once per command.
+     * Called at the start of Update(). Never call it while systems are running.
+     */
+    void PlaybackCommandBuffers();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // System Management
+
+    /**
+     * Optional params are forwarded to the constructor of TSystem.
+     */
+    template <typename TSystem, typename ...TArgs>
+    void AddSystem(TArgs&& ...Args);
+
+    template <typename TSystem>
+    void RemoveSystem();
+
+    template <typename TSystem>
+    const bool HasSystem() const;
+
+    template <typename TSystem>
+    TSystem* GetSystem() const;
+
+private:
+    void AddEntityToSystems(const Entity InEntity);
+    void RemoveEntityFromSystems(const Entity InEntity);
+    void UpdateEntityInSystems(const Entity InEntity, const Signature& Old, const Signature& New);
+
+    void ResizeEntityStorage(const unsigned int EntityID);
+
+    /** Hands out an entity ID and handle. Thread-safe, but the entity is not registered yet. */
+    Entity ReserveEntity();
+
+    /** Makes a reserved entity live: sizes storage for it and queues it to join systems */
+    void RegisterEntity(const Entity InEntity);
+
+    /** Hands out Count live entities with storage sized for all of them. They are not in any system yet. */
+    std::vector<Entity> ReserveEntities(const unsigned int Count);
+
+    /** Adds every entity in InEntities (which all have InSignature) to its systems and view caches */
+    void AddEntitiesToSystems(const std::vector<Entity>& InEntities, const Signature& InSignature);
+
+    template <typename TComponent>
+    void RegisterComponentInfo();
+
+    template <typename TComponent>
+    void RegisterTagComponent()
+    {
+        if constexpr (IsTagComponent<TComponent>)
+        {
+            TagComponents.set(Component<TComponent>::GetID());
+        }
+    }
+
+    /** Puts TComponent into storage for EntityID without touching its signature or systems */
+    template <typename TComponent, typename ...TArgs>
+    void StoreComponent(const unsigned int EntityID, TArgs&& ...Args);
+
+    /** Takes ComponentID out of storage for EntityID without touching its signature or systems */
+    void EraseComponent(const unsigned int EntityID, const unsigned int ComponentID);
+
+    /** The components of EntityID that systems and views see, i.e. its signature minus disabled components */
+    Signature GetEnabledSignature(const unsigned int EntityID) const
+    {
+        return EntityComponentSignatures[EntityID] & ~DisabledComponents[EntityID];
+    }
+
+    /** Flags EntityID's ComponentID as disabled (or not) without touching its systems */
+    void SetDisabledBit(const unsigned int EntityID, const unsigned int ComponentID, const bool Disabled);
+
+    /** Shared instance handed out in place of a tag component, which has no storage of its own */
+    template <typename TComponent>
+    static TComponent& GetTagInstance()
+    {
+        static TComponent tag;
+        return tag;
+    }
+
+    template <typename TComponent>
+    Pool<TComponent>* GetOrCreateComponentPool();
+
+    /** 
+     * Stamps EntityID's ComponentID as written now. The entity must already have the component.
+     * Only the first stamp per change version is logged, later ones in the same version are free.
+     */
+    void StampChange(const unsigned int ComponentID, const unsigned int EntityID)
+    {
+        const unsigned int version = ChangeVersion.load(std::memory_order_relaxed);
+        unsigned int& stamped = ComponentVersions[ComponentID][EntityID];
+
+        if (stamped == version)
+        {
+            return;
+        }
+
+        stamped = version;
+
+        std::vector<ChangeRecord>& changeLog = ChangeLogs[ComponentID];
+
+        if (changeLog.size() == changeLog.capacity())
+        {
+            CompactChangeLog(ComponentID);
+        }
+
+        changeLog.push_back({ EntityID, version });
+    }
+
+    /** Drops ComponentID's change records that a later stamp superseded, making room for more */
+    void CompactChangeLog(const unsigned int ComponentID);
+
+    /** Makes room to stamp ComponentID for every entity ID up to EntityID */
+    void ResizeChangeStorage(const unsigned int ComponentID, const unsigned int EntityID);
+
+    /** Every system and view cache matching InSignature, cached until systems or views change */
+    const SystemMembership& GetMembership(const Signature& InSignature);
+
+    /** What changes going from Old to New, cached until systems or views change */
+    const SystemMembershipDelta& GetMembershipDelta(const Signature& Old, const Signature& New);
+
+    /** Drops every cached membership, call whenever a system or view cache is added or removed */
+    void InvalidateMembership();
+
+    /** Rebuilds SystemDependents/SystemDependencyCounts from SystemOrder and each system's declared access */
+    void BuildSystemGraph();
+
+    /** Runs every system once, dispatching independent ones to the job system */
+    void RunSystems(const float DeltaTime);
+
+    /** Calls OnWorldRestored on every system in the order they were added */
+    void NotifyWorldRestored();
+
+    /** Creates the cache for Required, filling it from the smallest pool (or matching archetypes) */
+    ViewCache& BuildViewCache(const Signature& Required);
+
+    /** The cache for Required, building it the first time. Safe to call from any thread. */
+    ViewCache& GetViewCache(const Signature& Required);
+
+    /** Appends every entity whose ComponentID changed since LastVersion to Out and advances LastVersion */
+    void CollectChanged(const unsigned int ComponentID, unsigned int& LastVersion, std::vector<Entity>& Out);
+
+    /** Queue entities for ComponentID's OnAdd/OnRemove observers, if it has any */
+    void NotifyAdded(const unsigned int ComponentID, const Entity InEntity)
+    {
+        if (Observers[ComponentID].OnAdd.empty() == false)
+        {
+            Observers[ComponentID].Added.push_back(InEntity);
+            MarkLayoutChanged();
+        }
+    }
+
+    void NotifyRemoved(const unsigned int ComponentID, const Entity InEntity)
+    {
+        if (Observers[ComponentID].OnRemove.empty() == false)
+        {
+            Observers[ComponentID].Removed.push_back(InEntity);
+            MarkLayoutChanged();
+        }
+    }
+
+    /** Hands every observer its batch of entities since the last dispatch */
+    void DispatchObservers();
+
+    template <typename ...TComponents>
+    friend class ComponentView;
+
+    template <typename TComponent>
+    friend class ComponentCommandList;
+
+    friend class CommandBuffer;
+
+    /** Remembers InEntity's signature the first time the current playback changes it */
+    void TouchForPlayback(const Entity InEntity);
+
+    /** Save/load ops for every type in ComponentTypes, indexed by component ID */
+    static const std::vector<ComponentSnapshotOps>& GetSnapshotOps();
+
+    /** Writes the TComponent of each of EntityIDs, in order */
+    template <typename TComponent>
+    void SaveComponents(SnapshotWriter& Writer, const std::vector<unsigned int>& EntityIDs);
+
+    /** Reads back what SaveComponents wrote into storage. EntityIDs must have TComponent in their signatures already. */
+    template <typename TComponent>
+    void LoadComponents(SnapshotReader& Reader, const std::vector<unsigned int>& EntityIDs);
+
+    /** Destroys every entity and component without telling observers, leaving systems and views empty */
+    void ClearWorld();
+
+    /** Call on anything that changes which entities exist, their signatures, systems or views, or where their components live */
+    void MarkLayoutChanged() { LayoutVersion.fetch_add(1, std::memory_order_relaxed); }
+
+    /** Frames can't be restored across systems being added or removed, or the world being replaced */
+    void DropSavedFrames()
+    {
+        std::fill(RollbackFrames.begin(), RollbackFrames.end(), nullptr);
+        LatestFrame.reset();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Archetype storage
+
+    /** Neighbour of Source with ComponentID added (or removed), creating it if needed */
+    Archetype* GetArchetypeEdge(Archetype* Source, const unsigned int ComponentID, const bool Add);
+    Archetype* FindOrCreateArchetype(const Signature& InSignature);
+
+    /** Allocates a row in Target and moves over every component the entity's current archetype shares with it */
+    void MoveEntityToArchetype(const unsigned int EntityID, Archetype* Target);
+    void RemoveEntityFromArchetype(const unsigned int EntityID);
+
+    const EStorageMode StorageMode;
+
+    /** Where every pool's pages come from */
+    PageArena ComponentArena{ CoreStatics::PoolPageSize, CoreStatics::PoolPagesPerBlock };
+
+    /**
+     * Index indicates ComponentID, value is that component's pool (of entities with that component)
+     */
+    std::vector<IPool*> ComponentPools;
+
+    /**
+     * Index indicates EntityID, value is that entity's signature
+     */
+    std::vector<Signature> EntityComponentSignatures;
+
+    /**
+     * Index indicates EntityID, value is which of its components are disabled (always a subset of its signature)
+     */
+    std::vector<Signature> DisabledComponents;
+
+    /**
+     * Index indicates ComponentID, value is how many entities have that component disabled.
+     * DisabledTypes has a bit set for every component with a non-zero count, so views over
+     * components nobody has disabled can skip checking each entity.
+     */
+    std::vector<unsigned int> NumDisabled;
+    Signature DisabledTypes;
+
+    /** Every tag component stored so far */
+    Signature TagComponents;
+
+    /**
+     * TODO: refactor to use vector, not sure this implementation makes sense
+     */
+     std::unordered_map<std::type_index, System*> Systems;
+
+    /**
+     * Every system in the order it was added. Systems whose access conflicts always run in this order.
+     */
+    std::vector<System*> SystemOrder;
+
+    /**
+     * Dependency graph over SystemOrder. Index indicates the system's position in SystemOrder,
+     * SystemDependents holds the later systems that must wait for it and SystemDependencyCounts 
+     * the number of earlier systems it must wait for.
+     */
+    std::vector<std::vector<unsigned int>> SystemDependents;
+    std::vector<unsigned int> SystemDependencyCounts;
+    bool SystemGraphDirty = true;
+    bool ParallelUpdate = true;
+
+    /**
+     * Which systems and view caches match each signature seen so far, and which gain and lose an 
+     * entity for each signature change seen so far. Only systems actually affected get touched
+     * when an entity changes, however many systems there are.
+     */
+    std::unordered_map<Signature, SystemMembership> MembershipCache;
+    std::unordered_map<std::pair<Signature, Signature>, SystemMembershipDelta, SignaturePairHash> MembershipDeltaCache;
+
+    /** Guards ViewCaches lookups, since systems running in parallel can create views */
+    std::mutex ViewCacheMutex;
+
+    /** 
+     * Entities flagged to be added or removed in the next Update() call 
+     */
+    std::vector<Entity> EntitiesToBeAdded;
+    std::vector<Entity> EntitiesToBeRemoved;
+
+    /**
+     * Entity IDs of destroyed entities that can now be reused
+     */
+     std::queue<unsigned int> FreeEntityIDs;
+
+    /**
+     * Index indicates EntityID, value is the generation of the entity currently using that ID
+     */
+    std::vector<unsigned short> EntityGenerations;
+
+    /** Next never-used entity ID, handed out when FreeEntityIDs is empty */
+    unsigned int NextEntityID = 0;
+
+    static ECSManager* Active;
+
+    /**
+     * Archetype storage only. Index indicates ComponentID, value is how to move/destroy that type
+     */
+    std::vector<ComponentInfo> ComponentInfos;
+
+    /**
+     * Archetype storage only. Every archetype created so far, keyed by signature for lookup
+     * and kept in creation order in ArchetypeList for iteration.
+     */
+    std::unordered_map<Signature, Archetype*> Archetypes;
+    std::vector<Archetype*> ArchetypeList;
+
+    /**
+     * Archetype storage only. Index indicates EntityID, value is where its components live
+     */
+    std::vector<EntityLocation> EntityLocations;
+
+    /**
+     * Matched entities for each distinct View, keyed by the viewed components' signature
+     */
+    std::unordered_map<Signature, ViewCache> ViewCaches;
+
+    /**
+     * Index indicates ComponentID. ComponentVersions holds that type's change version per entity ID,
+     * ComponentTypeVersions the latest version any entity's component of that type was written at.
+     */
+    std::vector<std::vector<unsigned int>> ComponentVersions;
+    std::vector<unsigned int> ComponentTypeVersions;
+
+    /**
+     * Index indicates ComponentID, every entity stamped in order of version, so ViewChanged only
+     * looks at the entities stamped since it was last called. An entity stamped again leaves its
+     * older record behind until CompactChangeLog, only the record matching ComponentVersions counts.
+     * A type is only ever written by one thread at a time, so a log never needs locking.
+     */
+    std::vector<std::vector<ChangeRecord>> ChangeLogs;
+
+    /** Current change version. Every ViewChanged call moves it on so later writes stamp higher. */
+    std::atomic<unsigned int> ChangeVersion{ 1 };
+
+    /**
+     * Index indicates ComponentID, value is that type's observers and their pending batches
+     */
+    std::vector<ComponentObservers> Observers;
+
+    /** Guards handing out entity IDs, since command buffers reserve them from any thread */
+    std::mutex EntityIDMutex;
+
+    /** One command buffer per thread that has asked for one, played back in the order they were made */
+    std::unordered_map<std::thread::id, std::unique_ptr<CommandBuffer>> CommandBuffers;
+    std::vector<CommandBuffer*> CommandBufferOrder;
+    std::mutex CommandBufferMutex;
+
+    /**
+     * Entities changed by the playback in progress. Dense index in PlaybackTouched indicates 
+     * the index into PlaybackEntities/PlaybackOldSignatures.
+     */
+    SparseSet PlaybackTouched;
+    std::vector<Entity> PlaybackEntities;
+    std::vector<Signature> PlaybackOldSignatures;
+
+    /**
+     * Frames kept by SaveFrame, Frame % size indicates where each is kept. LatestFrame is the last 
+     * one saved or restored - whatever has not changed since then is shared with it.
+     */
+    std::vector<std::shared_ptr<const WorldFrame>> RollbackFrames;
+    std::shared_ptr<const WorldFrame> LatestFrame;
+
+    /** Counts layout changes (see MarkLayoutChanged), LatestLayoutVersion is the count as of LatestFrame */
+    std::atomic<unsigned int> LayoutVersion{ 0 };
+    unsigned int LatestLayoutVersion = 0;
+};
+
+/**
+ * Typed query over every entity that has all of TComponents. Get one from ECSManager::View.
+ * 
+ * Each() hands Fn references straight out of storage - no per-entity signature checks and
+ * no copy of the entity list. With sparse-set storage it walks the view's cached entity IDs,
+ * with archetype storage it walks the matching archetypes chunk by chunk.
+ * 
+ * Don't add or remove any of TComponents while iterating; DestroyEntity is fine since
+ * destroyed entities are only cleared out on the next ECSManager::Update.
+ */
+template <typename ...TComponents>
+class ComponentView
+{
+public:
+    ComponentView(ECSManager* InOwner, ViewCache* InCache) : Owner(InOwner), Cache(InCache) {}
+
+    const size_t Size() const { return Cache->EntityIDs.Size(); }
+    const bool Empty() const { return Cache->EntityIDs.Empty(); }
+
+    /** IDs of every matching entity (sparse-set and archetype storage alike) */
+    const std::vector<unsigned int>& GetEntityIDs() const { return Cache->EntityIDs.GetDense(); }
+
+    /**
+     * Fn can take (Entity, TComponents&...) or just (TComponents&...).
+     * Take the components Fn only reads by const reference: the rest are stamped as changed for 
+     * ECSManager::ViewChanged. Name the parameter types, a generic (auto&) Fn that writes to 
+     * a parameter will not compile here.
+     */
+    template <typename TFunc>
+    void Each(TFunc&& Fn);
+
+    /**
+     * Each, split across the job system's workers: ranges of ChunkSize entities with sparse-set 
+     * storage, one archetype chunk per job with archetype storage. Returns once every entity is done.
+     * Fn may run concurrently with itself, so it must only touch the components it is given.
+     */
+    template <typename TFunc>
+    void ParallelEach(const size_t ChunkSize, TFunc&& Fn);
+
+private:
+    /** TComponents&..., except TConst which is passed as const */
+    template <typename TComponent, typename TConst>
+    using ArgFor = std::conditional_t<std::is_same_v<TComponent, TConst>, const TComponent&, TComponent&>;
+
+    /** Whether Fn needs TComponent by non-const reference, i.e. might write it */
+    template <typename TFunc, typename TComponent>
+    static constexpr bool Writes = 
+        std::is_invocable_v<TFunc&, Entity, ArgFor<TComponents, TComponent>...> == false &&
+        std::is_invocable_v<TFunc&, ArgFor<TComponents, TComponent>...> == false;
+
+    template <typename TFunc>
+    void Invoke(TFunc& Fn, const unsigned int EntityID, TComponents& ...Components)
+    {
+        if constexpr (std::is_invocable_v<TFunc&, Entity, TComponents&...>)
+        {
+            Fn(Entity(EntityID, Owner->EntityGenerations[EntityID]), Components...);
+        }
+        else
+        {
+            Fn(Components...);
+        }
+
+    }
+
+    /** EntityID's TComponent out of its pool (in Pools, one per TComponents) */
+    template <typename TComponent, typename TPools>
+    static TComponent& FromPool(const TPools& Pools, const unsigned int EntityID)
+    {
+        if constexpr (IsTagComponent<TComponent>)
+        {
+            return ECSManager::GetTagInstance<TComponent>();
+        }
+        else
+        {
+            return std::get<Pool<TComponent>*>(Pools)->Get(EntityID);
+        }
+    }
+
+    /** Row's TComponent out of its chunk column (in Columns, one per TComponents) */
+    template <typename TComponent, typename TColumns>
+    static TComponent& FromColumn(const TColumns& Columns, const unsigned int Row)
+    {
+        if constexpr (IsTagComponent<TComponent>)
+        {
+            return ECSManager::GetTagInstance<TComponent>();
+        }
+        else
+        {
+            return std::get<TComponent*>(Columns)[Row];
+        }
+    }
+
+    /** Archetype storage only. Whether some entity may have one of the viewed components disabled. */
+    const bool MayHaveDisabled() const
+    {
+        return Owner->DisabledTypes.Intersects(Cache->Required);
+    }
+
+    /** Archetype storage only. Archetypes don't know about disabled components, the view cache does. */
+    const bool IsDisabled(const unsigned int EntityID) const
+    {
+        return Owner->DisabledComponents[EntityID].Intersects(Cache->Required);
+    }
+
+    /**
+     * Stamps every entity's TComponent in the view if Fn writes it. Done on the calling thread 
+     * before iterating, so ParallelEach's workers never touch the change log.
+     */
+    template <typename TFunc, typename TComponent>
+    void StampIfWritten()
+    {
+        if constexpr (Writes<TFunc, TComponent> && IsTagComponent<TComponent> == false)
+        {
+            constexpr auto componentID = Component<TComponent>::GetID();
+
+            for (const unsigned int entityID : Cache->EntityIDs.GetDense())
+            {
+                Owner->StampChange(componentID, entityID);
+            }
+
+            Owner->ComponentTypeVersions[componentID] = Owner->ChangeVersion.load();
+        }
+    }
+
+    ECSManager* Owner;
+    ViewCache* Cache;
+};
+
+template <typename TComponent, typename ...TArgs>
+void ECSManager::AddComponent(Entity InEntity, TArgs&& ...Args)
+{
+    const auto entityID = InEntity.GetID();
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    ResizeEntityStorage(entityID);
+    StoreComponent<TComponent>(entityID, std::forward<TArgs>(Args)...);
+
+    // Capture the old signature
+    const Signature oldEntitySignature = GetEnabledSignature(entityID);
+
+    if (EntityComponentSignatures[entityID].test(componentID) == false)
+    {
+        NotifyAdded(componentID, InEntity);
+    }
+
+    // Update the entity's signature to indicate that this component is assigned to this entity
+    EntityComponentSignatures[entityID].set(componentID);
+    const Signature newEntitySignature = GetEnabledSignature(entityID);
+
+    UpdateEntityInSystems(InEntity, oldEntitySignature, newEntitySignature);
+}
+
+template <typename TComponent, typename ...TArgs>
+void ECSManager::StoreComponent(const unsigned int EntityID, TArgs&& ...Args)
+{
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    RegisterTagComponent<TComponent>();
+
+    if (StorageMode == EStorageMode::Archetype)
+    {
+        RegisterComponentInfo<TComponent>();
+
+        const EntityLocation& location = EntityLocations[EntityID];
+
+        if constexpr (IsTagComponent<TComponent>)
+        {
+            // Only the archetype changes, there is nothing to construct
+            if (location.Owner == nullptr || location.Owner->HasColumn(componentID) == false)
+            {
+                MoveEntityToArchetype(EntityID, GetArchetypeEdge(location.Owner, componentID, true));
+            }
+        }
+        else if (location.Owner != nullptr && location.Owner->HasColumn(componentID))
+        {
+            // Already in an archetype with this component, just overwrite it
+            void* existing = location.Owner->GetComponent(componentID, location.Chunk, location.Row);
+            *static_cast<TComponent*>(existing) = TComponent(std::forward<TArgs>(Args)...);
+        }
+        else
+        {
+            // Move the entity's row to the archetype with TComponent added, then construct 
+            // the new component in place in its column
+            MoveEntityToArchetype(EntityID, GetArchetypeEdge(location.Owner, componentID, true));
+
+            const EntityLocation& newLocation = EntityLocations[EntityID];
+            void* column = newLocation.Owner->GetComponent(componentID, newLocation.Chunk, newLocation.Row);
+            new (column) TComponent(std::forward<TArgs>(Args)...);
+        }
+    }
+    else if constexpr (IsTagComponent<TComponent> == false)
+    {
+        // Construct the component in place in the pool, forwarding constructor args if they are present
+        GetOrCreateComponentPool<TComponent>()->Emplace(EntityID, std::forward<TArgs>(Args)...);
+    }
+
+    ResizeChangeStorage(componentID, EntityID);
+    StampChange(componentID, EntityID);
+    ComponentTypeVersions[componentID] = ChangeVersion.load();
+}
+
+template <typename TComponent>
+void ECSManager::RegisterComponentInfo()
+{
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    if (componentID >= ComponentInfos.size())
+    {
+        ComponentInfos.resize(CoreStatics::MaxNumComponentTypes);
+    }
+
+    if (ComponentInfos[componentID].IsValid() == false)
+    {
+        ComponentInfos[componentID] = ComponentInfo::Create<TComponent>();
+    }
+}
+
+template <typename ...TComponents>
+std::vector<Entity> ECSManager::CreateEntities(const unsigned int Count, const TComponents& ...Prototype)
+{
+    std::vector<Entity> entities = ReserveEntities(Count);
+
+    if (entities.empty())
+    {
+        return entities;
+    }
+
+    Signature signature;
+    (signature.set(Component<TComponents>::GetID()), ...);
+    (RegisterTagComponent<TComponents>(), ...);
+
+    if constexpr (sizeof...(TComponents) > 0)
+    {
+        if (StorageMode == EStorageMode::Archetype)
+        {
+            (RegisterComponentInfo<TComponents>(), ...);
+
+            // Every entity lands in the same archetype, so no edge walking per component
+            Archetype* archetype = FindOrCreateArchetype(signature);
+
+            auto construct = [archetype](const EntityLocation& Location, const auto& InPrototype)
+            {
+                using TComponent = std::decay_t<decltype(InPrototype)>;
+
+                if constexpr (IsTagComponent<TComponent> == false)
+                {
+                    new (archetype->GetComponent(Component<TComponent>::GetID(), Location.Chunk, Location.Row)) TComponent(InPrototype);
+                }
+            };
+
+            for (const Entity& entity : entities)
+            {
+                const EntityLocation location = archetype->AddRow(entity.GetID());
+                EntityLocations[entity.GetID()] = location;
+
+                (construct(location, Prototype), ...);
+            }
+        }
+        else
+        {
+            auto fillPool = [this, &entities](const auto& InPrototype)
+            {
+                using TComponent = std::decay_t<decltype(InPrototype)>;
+
+                if constexpr (IsTagComponent<TComponent> == false)
+                {
+                    Pool<TComponent>* pool = GetOrCreateComponentPool<TComponent>();
+                    pool->Reserve(pool->Size() + static_cast<unsigned int>(entities.size()));
+
+                    for (const Entity& entity : entities)
+                    {
+                        pool->Emplace(entity.GetID(), InPrototype);
+                    }
+                }
+            };
+
+            (fillPool(Prototype), ...);
+        }
+    }
+
+    const unsigned int highestID = std::max_element(entities.begin(), entities.end())->GetID();
+
+    auto stampAll = [this, &entities, highestID](const unsigned int ComponentID)
+    {
+        ResizeChangeStorage(ComponentID, highestID);
+
+        for (const Entity& entity : entities)
+        {
+            StampChange(ComponentID, entity.GetID());
+        }
+
+        ComponentTypeVersions[ComponentID] = ChangeVersion.load();
+
+        if (Observers[ComponentID].OnAdd.empty() == false)
+        {
+            Observers[ComponentID].Added.insert(Observers[ComponentID].Added.end(), entities.begin(), entities.end());
+        }
+    };
+
+    (stampAll(Component<TComponents>::GetID()), ...);
+
+    for (const Entity& entity : entities)
+    {
+        EntityComponentSignatures[entity.GetID()] = signature;
+    }
+
+    AddEntitiesToSystems(entities, signature);
+
+    return entities;
+}
+
+template <typename TComponent>
+std::vector<Entity> ECSManager::ViewChanged(unsigned int& LastVersion)
+{
+    std::vector<Entity> changed;
+    CollectChanged(Component<TComponent>::GetID(), LastVersion, changed);
+
+    return changed;
+}
+
+template <typename TComponent>
+void ECSManager::OnAdd(ComponentObserver Fn)
+{
+    Observers[Component<TComponent>::GetID()].OnAdd.push_back(std::move(Fn));
+}
+
+template <typename TComponent>
+void ECSManager::OnRemove(ComponentObserver Fn)
+{
+    Observers[Component<TComponent>::GetID()].OnRemove.push_back(std::move(Fn));
+}
+
+template <typename TComponent>
+void ECSManager::OnChange(ComponentObserver Fn)
+{
+    ComponentObservers& observers = Observers[Component<TComponent>::GetID()];
+
+    if (observers.OnChange.empty())
+    {
+        // Only report writes from here on
+        observers.ChangeVersion = ChangeVersion.fetch_add(1);
+    }
+
+    observers.OnChange.push_back(std::move(Fn));
+}
+
+template <typename TComponent>
+void ECSManager::MarkChanged(const Entity InEntity)
+{
+    assert(HasComponent<TComponent>(InEntity));
+
+    constexpr auto componentID = Component<TComponent>::GetID();
+    StampChange(componentID, InEntity.GetID());
+    ComponentTypeVersions[componentID] = ChangeVersion.load();
+}
+
+template <typename TComponent>
+Pool<TComponent>* ECSManager::GetOrCreateComponentPool()
+{
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    // Bounds check on the array of pools, allocate nullptrs as needed
+    if (componentID >= ComponentPools.size())
+    {
+        const auto newSize = (ComponentPools.size() > 0) ? ComponentPools.size() * 2 : 32;
+        ComponentPools.resize(newSize, nullptr);
+    }
+
+    // If we needed to add nullptrs, allocate a new Pool and store it
+    if (ComponentPools[componentID] == nullptr)
+    {
+        ComponentPools[componentID] = new Pool<TComponent>(ComponentArena);
+    }
+
+    return static_cast<Pool<TComponent>*>((ComponentPools[componentID]));
+}
+
+template <typename TComponent>
+const bool ECSManager::HasComponent(const Entity InEntity) const
+{
+    assert(InEntity.GetID() < EntityComponentSignatures.size());
+    return EntityComponentSignatures[InEntity.GetID()].test(Component<TComponent>::GetID());
+}
+
+template <typename TComponent>
+void ECSManager::RemoveComponent(Entity InEntity)
+{
+    assert(InEntity.GetID() < EntityComponentSignatures.size());
+
+    const auto entityID = InEntity.GetID();
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    if (HasComponent<TComponent>(InEntity) == false)
+    {
+        return;
+    }
+
+    EraseComponent(entityID, componentID);
+    NotifyRemoved(componentID, InEntity);
+
+    const Signature oldSignature = GetEnabledSignature(entityID);
+    EntityComponentSignatures[entityID].set(componentID, false);
+    SetDisabledBit(entityID, componentID, false);
+    const Signature newSignature = GetEnabledSignature(entityID);
+
+    UpdateEntityInSystems(InEntity, oldSignature, newSignature);
+}
+
+template <typename TComponent>
+TComponent& ECSManager::GetComponent(const Entity InEntity)
+{
+    assert(HasComponent<TComponent>(InEntity));
+    const auto entityId = InEntity.GetID();
+    constexpr auto componentId = Component<TComponent>::GetID();
+
+    if constexpr (IsTagComponent<TComponent>)
+    {
+        return GetTagInstance<TComponent>();
+    }
+
+    if (StorageMode == EStorageMode::Archetype)
+    {
+        const EntityLocation& location = EntityLocations[entityId];
+        return *static_cast<TComponent*>(location.Owner->GetComponent(componentId, location.Chunk, location.Row));
+    }
+
+    Pool<TComponent>* componentPool = static_cast<Pool<TComponent>*>((ComponentPools[componentId]));
+
+    return componentPool->Get(entityId);
+}
+
+template <typename TComponent>
+void ECSManager::SetComponentEnabled(const Entity InEntity, const bool Enabled)
+{
+    assert(HasComponent<TComponent>(InEntity));
+
+    const auto entityID = InEntity.GetID();
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    if (DisabledComponents[entityID].test(componentID) == !Enabled)
+    {
+        return;
+    }
+
+    const Signature oldSignature = GetEnabledSignature(entityID);
+    SetDisabledBit(entityID, componentID, !Enabled);
+
+    // Storage stays put, only membership changes (and the delta for it is cached)
+    UpdateEntityInSystems(InEntity, oldSignature, GetEnabledSignature(entityID));
+}
+
+template <typename TComponent>
+const bool ECSManager::IsComponentEnabled(const Entity InEntity) const
+{
+    assert(InEntity.GetID() < DisabledComponents.size());
+    return HasComponent<TComponent>(InEntity) && DisabledComponents[InEntity.GetID()].test(Component<TComponent>::GetID()) == false;
+}
+
+template <typename TComponent>
+Pool<TComponent>* ECSManager::GetComponentPool() const
+{
+    constexpr auto componentID = Component<TComponent>::GetID();
+
+    if (componentID < ComponentPools.size())
+    {
+        return static_cast<Pool<TComponent>*>(ComponentPools[componentID]);
+    }
+
+    return nullptr;
+}
+
+template <typename ...TComponents, typename TFunc>
+void ECSManager::ForEachChunk(TFunc&& Fn)
+{
+    assert(StorageMode == EStorageMode::Archetype);
+
+    Signature required;
+    (required.set(Component<TComponents>::GetID()), ...);
+
+    for (Archetype* archetype : ArchetypeList)
+    {
+        if (archetype->GetSignature().Contains(required) == false)
+        {
+            continue;
+        }
+
+        for (unsigned int chunk = 0; chunk < archetype->GetNumChunks(); ++chunk)
+        {
+            Fn(archetype->GetChunkCount(chunk), 
+                archetype->GetColumn<TComponents>(Component<TComponents>::GetID(), chunk)...);
+        }
+    }
+}
+
+template <typename ...TComponents>
+ComponentView<TComponents...> ECSManager::View()
+{
+    Signature required;
+    (required.set(Component<TComponents>::GetID()), ...);
+
+    return ComponentView<TComponents...>(this, &GetViewCache(required));
+}
+
+template <typename ...TComponents, typename TFunc>
+void ECSManager::Each(TFunc&& Fn)
+{
+    View<TComponents...>().Each(std::forward<TFunc>(Fn));
+}
+
+template <typename ...TComponents>
+template <typename TFunc>
+void ComponentView<TComponents...>::Each(TFunc&& Fn)
+{
+    (StampIfWritten<TFunc, TComponents>(), ...);
+
+    if (Owner->StorageMode == EStorageMode::Archetype)
+    {
+        const bool checkDisabled = MayHaveDisabled();
+
+        for (Archetype* archetype : Owner->ArchetypeList)
+        {
+            if (archetype->GetSignature().Contains(Cache->Required) == false)
+            {
+                continue;
+            }
+
+            for (unsigned int chunk = 0; chunk < archetype->GetNumChunks(); ++chunk)
+            {
+                const unsigned int* entityIDs = archetype->GetEntityIDs(chunk);
+                const auto columns = std::make_tuple(
+                    archetype->GetColumn<TComponents>(Component<TComponents>::GetID(), chunk)...
+                );
+
+                for (unsigned int row = 0; row < archetype->GetChunkCount(chunk); ++row)
+                {
+                    if (checkDisabled == false || IsDisabled(entityIDs[row]) == false)
+                    {
+                        Invoke(Fn, entityIDs[row], FromColumn<TComponents>(columns, row)...);
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        const auto pools = std::make_tuple(Owner->GetComponentPool<TComponents>()...);
+
+        for (const unsigned int entityID : Cache->EntityIDs.GetDense())
+        {
+            Invoke(Fn, entityID, FromPool<TComponents>(pools, entityID)...);
+        }
+    }
+}
+
+template <typename ...TComponents>
+template <typename TFunc>
+void ComponentView<TComponents...>::ParallelEach(const size_t ChunkSize, TFunc&& Fn)
+{
+    (StampIfWritten<TFunc, TComponents>(), ...);
+
+    if (Owner->StorageMode == EStorageMode::Archetype)
+    {
+        // Chunks are already nicely sized batches of contiguous components
+        std::vector<std::pair<Archetype*, unsigned int>> chunks;
+
+        for (Archetype* archetype : Owner->ArchetypeList)
+        {
+            if (archetype->GetSignature().Contains(Cache->Required))
+            {
+                for (unsigned int chunk = 0; chunk < archetype->GetNumChunks(); ++chunk)
+                {
+                    chunks.emplace_back(archetype, chunk);
+                }
+            }
+        }
+
+        const bool checkDisabled = MayHaveDisabled();
+
+        JobSystem::Get().ParallelFor(chunks.size(), 1, [this, &chunks, &Fn, checkDisabled](const size_t Begin, const size_t End)
+        {
+            for (size_t idx = Begin; idx < End; ++idx)
+            {
+                Archetype* archetype = chunks[idx].first;
+                const unsigned int chunk = chunks[idx].second;
+                const unsigned int* entityIDs = archetype->GetEntityIDs(chunk);
+                const auto columns = std::make_tuple(
+                    archetype->GetColumn<TComponents>(Component<TComponents>::GetID(), chunk)...
+                );
+
+                for (unsigned int row = 0; row < archetype->GetChunkCount(chunk); ++row)
+                {
+                    if (checkDisabled == false || IsDisabled(entityIDs[row]) == false)
+                    {
+                        Invoke(Fn, entityIDs[row], FromColumn<TComponents>(columns, row)...);
+                    }
+                }
+            }
+        });
+    }
+    else
+    {
+        const auto pools = std::make_tuple(Owner->GetComponentPool<TComponents>()...);
+        const std::vector<unsigned int>& entityIDs = Cache->EntityIDs.GetDense();
+
+        JobSystem::Get().ParallelFor(entityIDs.size(), ChunkSize, [this, &pools, &entityIDs, &Fn](const size_t Begin, const size_t End)
+        {
+            for (size_t idx = Begin; idx < End; ++idx)
+            {
+                Invoke(Fn, entityIDs[idx], FromPool<TComponents>(pools, entityIDs[idx])...);
+            }
+        });
+    }
+}
+
+template <typename TSystem, typename ...TArgs>
+void ECSManager::AddSystem(TArgs&& ...Args)
+{
+    const auto systemIdx = std::type_index(typeid(TSystem));
+
+    if (Systems.count(systemIdx) == 0)
+    {
+        System* newSystem = new TSystem(std::forward<TArgs>(Args)...);
+        newSystem->Owner = this;
+        Systems[systemIdx] = newSystem;
+        SystemOrder.push_back(newSystem);
+        SystemGraphDirty = true;
+        InvalidateMembership();
+        DropSavedFrames();
+    }
+}
+
+template <typename TSystem>
+void ECSManager::RemoveSystem()
+{
+    const auto systemIdx = std::type_index(typeid(TSystem));
+    
+    const auto systemItr = Systems.find(systemIdx);
+
+    if (systemItr != Systems.end())
+    {
+        System* system = systemItr->second;
+        SystemOrder.erase(std::find(SystemOrder.begin(), SystemOrder.end(), system));
+        Systems.erase(systemItr);
+        SystemGraphDirty = true;
+        InvalidateMembership();
+        DropSavedFrames();
+        delete system;
+    }
+}
+
+template <typename TSystem>
+const bool ECSManager::HasSystem() const
+{
+    const auto systemIdx = std::type_index(typeid(TSystem));
+    return Systems.count(systemIdx);
+}
+
+template <typename TSystem>
+TSystem* ECSManager::GetSystem() const
+{
+    const auto systemIdx = std::type_index(typeid(TSystem));
+    const auto systemItr = Systems.find(systemIdx);
+
+    if (systemItr != Systems.end())
+    {
+        const auto& pair = *systemItr;
+
+        if (pair.second != nullptr)
+        {
+            return static_cast<TSystem*>(pair.second);
+        }
+    }
+    
+    return nullptr;
+}
+
+template <typename TComponent>
+void System::RequireComponent()
+{
+    ComponentSignature.set(Component<TComponent>::GetID());
+}
+
+template <typename TCompare>
+void System::SortEntities(TCompare&& Compare)
+{
+    if (std::is_sorted(Entities.begin(), Entities.end(), Compare))
+    {
+        return;
+    }
+
+    // Stable so entities that compare equal keep their order from frame to frame
+    std::stable_sort(Entities.begin(), Entities.end(), Compare);
+
+    EntityIDs.Clear();
+
+    for (const Entity& entity : Entities)
+    {
+        EntityIDs.Insert(entity.GetID());
+    }
+}
+
+template <typename TFunc>
+void System::ParallelForEach(const size_t ChunkSize, TFunc&& Fn)
+{
+    const std::vector<Entity>& entities = Entities;
+
+    JobSystem::Get().ParallelFor(entities.size(), ChunkSize, [&entities, &Fn](const size_t Begin, const size_t End)
+    {
+        for (size_t idx = Begin; idx < End; ++idx)
+        {
+            Fn(entities[idx]);
+        }
+    });
+}
+
+template <typename TComponent>
+void System::ReadsComponent()
+{
+    ReadSignature.set(Component<TComponent>::GetID());
+    AccessDeclared = true;
+}
+
+template <typename TComponent>
+void System::WritesComponent()
+{
+    WriteSignature.set(Component<TComponent>::GetID());
+    AccessDeclared = true;
+}
+
+
+template <typename TComponent, typename ...TArgs>
+void Entity::AddComponent(TArgs&& ...Args)
+{
+    assert(ECSManager::GetActive() != nullptr);
+    ECSManager::GetActive()->AddComponent<TComponent>(*this, std::forward<TArgs>(Args)...);
+}
+
+template <typename TComponent>
+void Entity::RemoveComponent()
+{
+    assert(ECSManager::GetActive() != nullptr);
+    ECSManager::GetActive()->RemoveComponent<TComponent>(*this);
+}
+
+template <typename TComponent>
+const bool Entity::HasComponent() const
+{
+    assert(ECSManager::GetActive() != nullptr);
+    return ECSManager::GetActive()->HasComponent<TComponent>(*this);
+}
+
+template <typename TComponent>
 TComponent& Entity::GetComponent() const
 {
-    assert(Owner != nullptr);
-    return Owner->GetComponent<TComponent>(*this);
-}
\ No newline at end of file
+    assert(ECSManager::GetActive() != nullptr);
+    return ECSManager::GetActive()->GetComponent<TComponent>(*this);
+}
+
+template <typename TComponent>
+void Entity::SetComponentEnabled(const bool Enabled)
+{
+    assert(ECSManager::GetActive() != nullptr);
+    ECSManager::GetActive()->SetComponentEnabled<TComponent>(*this, Enabled);
+}
+
+template <typename TComponent>
+const bool Entity::IsComponentEnabled() const
+{
+    assert(ECSManager::GetActive() != nullptr);
+    return ECSManager::GetActive()->IsComponentEnabled<TComponent>(*this);
+}
@@ -0,0 +1,342 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "ECS.h"
+#include "CommandBuffer.h"
+#include "Components/TransformComponent.h"
+#include "Components/RigidBodyComponent.h"
+#include <chrono>
+
+/**
+ * Which entities exist and everything derived from their signatures, as of some frame.
+ * Frames share one of these for as long as no entity is created, destroyed or changes signature.
+ */
+struct WorldLayout
+{
+    std::vector<Signature> Signatures;
+    std::vector<Signature> DisabledComponents;
+    std::vector<unsigned int> NumDisabled;
+    Signature DisabledTypes;
+
+    std::vector<unsigned short> Generations;
+    std::queue<unsigned int> FreeEntityIDs;
+    unsigned int NextEntityID = 0;
+    unsigned int NumEntities = 0;
+    std::vector<Entity> EntitiesToBeAdded;
+    std::vector<Entity> EntitiesToBeRemoved;
+
+    /** Archetype storage only */
+    std::vector<EntityLocation> EntityLocations;
+
+    /** Index indicates the system's position in SystemOrder */
+    std::vector<std::vector<Entity>> SystemEntities;
+    std::vector<std::pair<Signature, std::vector<unsigned int>>> Views;
+
+    /** Index indicates ComponentID, entities waiting for OnAdd and OnRemove observers */
+    std::vector<std::pair<std::vector<Entity>, std::vector<Entity>>> ObserverBatches;
+};
+
+struct WorldFrame
+{
+    unsigned int Frame = 0;
+    std::shared_ptr<const WorldLayout> Layout;
+
+    /** Index indicates ComponentID, nullptr where there was no pool */
+    std::vector<std::shared_ptr<const IPoolFrame>> Pools;
+
+    /** Index indicates the archetype's position in ArchetypeList */
+    std::vector<std::shared_ptr<const ArchetypeFrame>> Archetypes;
+};
+
+namespace
+{
+    /** Copies Saved over the start of Live and resets the rest, which only ever grows */
+    template <typename T>
+    void RestoreVector(std::vector<T>& Live, const std::vector<T>& Saved, const T& Default)
+    {
+        assert(Live.size() >= Saved.size());
+
+        std::copy(Saved.begin(), Saved.end(), Live.begin());
+        std::fill(Live.begin() + Saved.size(), Live.end(), Default);
+    }
+}
+
+void ECSManager::SetRollbackFrames(const unsigned int NumFrames)
+{
+    RollbackFrames.assign(NumFrames, nullptr);
+    LatestFrame.reset();
+}
+
+void ECSManager::SaveFrame(const unsigned int Frame)
+{
+    if (RollbackFrames.empty())
+    {
+        return;
+    }
+
+    PlaybackCommandBuffers();
+
+    auto frame = std::make_shared<WorldFrame>();
+    frame->Frame = Frame;
+
+    if (LatestFrame != nullptr && LayoutVersion.load() == LatestLayoutVersion)
+    {
+        frame->Layout = LatestFrame->Layout;
+    }
+    else
+    {
+        // Storage past NextEntityID has never been used, restoring resets it anyway
+        const size_t numUsed = std::min<size_t>(NextEntityID, EntityComponentSignatures.size());
+
+        auto layout = std::make_shared<WorldLayout>();
+        layout->Signatures.assign(EntityComponentSignatures.begin(), EntityComponentSignatures.begin() + numUsed);
+        layout->DisabledComponents.assign(DisabledComponents.begin(), DisabledComponents.begin() + numUsed);
+        layout->NumDisabled = NumDisabled;
+        layout->DisabledTypes = DisabledTypes;
+        layout->Generations.assign(EntityGenerations.begin(), EntityGenerations.begin() + numUsed);
+        layout->FreeEntityIDs = FreeEntityIDs;
+        layout->NextEntityID = NextEntityID;
+        layout->NumEntities = NumEntities;
+        layout->EntitiesToBeAdded = EntitiesToBeAdded;
+        layout->EntitiesToBeRemoved = EntitiesToBeRemoved;
+
+        if (StorageMode == EStorageMode::Archetype)
+        {
+            layout->EntityLocations.assign(EntityLocations.begin(), EntityLocations.begin() + numUsed);
+        }
+
+        layout->SystemEntities.reserve(SystemOrder.size());
+
+        for (System* system : SystemOrder)
+        {
+            layout->SystemEntities.push_back(system->Entities);
+        }
+
+        for (const auto& [required, cache] : ViewCaches)
+        {
+            layout->Views.emplace_back(required, cache.EntityIDs.GetDense());
+        }
+
+        layout->ObserverBatches.resize(Observers.size());
+
+        for (size_t componentID = 0; componentID < Observers.size(); ++componentID)
+        {
+            layout->ObserverBatches[componentID] = { Observers[componentID].Added, Observers[componentID].Removed };
+        }
+
+        frame->Layout = std::move(layout);
+    }
+
+    frame->Pools.resize(ComponentPools.size());
+
+    for (size_t componentID = 0; componentID < ComponentPools.size(); ++componentID)
+    {
+        if (ComponentPools[componentID] != nullptr)
+        {
+            const bool hasPrevious = LatestFrame != nullptr && componentID < LatestFrame->Pools.size();
+            const IPoolFrame* previous = hasPrevious ? LatestFrame->Pools[componentID].get() : nullptr;
+
+            frame->Pools[componentID] = ComponentPools[componentID]->SaveFrame(previous);
+        }
+    }
+
+    frame->Archetypes.reserve(ArchetypeList.size());
+
+    for (size_t idx = 0; idx < ArchetypeList.size(); ++idx)
+    {
+        const bool hasPrevious = LatestFrame != nullptr && idx < LatestFrame->Archetypes.size();
+        const ArchetypeFrame* previous = hasPrevious ? LatestFrame->Archetypes[idx].get() : nullptr;
+
+        frame->Archetypes.push_back(ArchetypeList[idx]->SaveFrame(previous));
+    }
+
+    RollbackFrames[Frame % RollbackFrames.size()] = frame;
+    LatestFrame = std::move(frame);
+    LatestLayoutVersion = LayoutVersion.load();
+}
+
+const bool ECSManager::RestoreFrame(const unsigned int Frame)
+{
+    if (RollbackFrames.empty())
+    {
+        return false;
+    }
+
+    const std::shared_ptr<const WorldFrame> frame = RollbackFrames[Frame % RollbackFrames.size()];
+
+    if (frame == nullptr || frame->Frame != Frame)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(CommandBufferMutex);
+
+        for (CommandBuffer* buffer : CommandBufferOrder)
+        {
+            buffer->Clear();
+        }
+    }
+
+    // Pools and archetypes made since the frame was saved had nothing in them back then
+    for (size_t componentID = 0; componentID < ComponentPools.size(); ++componentID)
+    {
+        if (ComponentPools[componentID] == nullptr)
+        {
+            continue;
+        }
+
+        if (componentID < frame->Pools.size() && frame->Pools[componentID] != nullptr)
+        {
+            ComponentPools[componentID]->RestoreFrame(*frame->Pools[componentID]);
+        }
+        else
+        {
+            ComponentPools[componentID]->Clear();
+        }
+    }
+
+    static const ArchetypeFrame emptyArchetype;
+
+    for (size_t idx = 0; idx < ArchetypeList.size(); ++idx)
+    {
+        ArchetypeList[idx]->RestoreFrame((idx < frame->Archetypes.size()) ? *frame->Archetypes[idx] : emptyArchetype);
+    }
+
+    // Nothing to do if no entity was created, destroyed or changed since the frame saved (or restored) last
+    const bool layoutChanged = LatestFrame == nullptr || LatestFrame->Layout != frame->Layout || LayoutVersion.load() != LatestLayoutVersion;
+
+    if (layoutChanged)
+    {
+        const WorldLayout& layout = *frame->Layout;
+
+        RestoreVector(EntityComponentSignatures, layout.Signatures, Signature());
+        RestoreVector(DisabledComponents, layout.DisabledComponents, Signature());
+        RestoreVector(EntityGenerations, layout.Generations, static_cast<unsigned short>(0));
+        RestoreVector(EntityLocations, layout.EntityLocations, EntityLocation());
+        NumDisabled = layout.NumDisabled;
+        DisabledTypes = layout.DisabledTypes;
+
+        FreeEntityIDs = layout.FreeEntityIDs;
+        NextEntityID = layout.NextEntityID;
+        NumEntities = layout.NumEntities;
+        EntitiesToBeAdded = layout.EntitiesToBeAdded;
+        EntitiesToBeRemoved = layout.EntitiesToBeRemoved;
+
+        std::vector<unsigned int> entityIDs;
+
+        for (size_t idx = 0; idx < SystemOrder.size(); ++idx)
+        {
+            System* system = SystemOrder[idx];
+            system->Entities = layout.SystemEntities[idx];
+
+            entityIDs.clear();
+
+            for (const Entity& entity : system->Entities)
+            {
+                entityIDs.push_back(entity.GetID());
+            }
+
+            system->EntityIDs.Assign(entityIDs);
+        }
+
+        std::vector<Signature> newViews;
+
+        for (auto& [required, cache] : ViewCaches)
+        {
+            cache.EntityIDs.Assign(std::vector<unsigned int>());
+            newViews.push_back(required);
+        }
+
+        for (const auto& [required, viewEntityIDs] : layout.Views)
+        {
+            ViewCaches[required].EntityIDs.Assign(viewEntityIDs);
+            newViews.erase(std::find(newViews.begin(), newViews.end(), required));
+        }
+
+        // Views made since the frame was saved are filled from the restored world
+        for (const Signature& required : newViews)
+        {
+            BuildViewCache(required);
+        }
+
+        for (size_t componentID = 0; componentID < Observers.size(); ++componentID)
+        {
+            Observers[componentID].Added = layout.ObserverBatches[componentID].first;
+            Observers[componentID].Removed = layout.ObserverBatches[componentID].second;
+        }
+    }
+
+    LatestFrame = frame;
+    LatestLayoutVersion = LayoutVersion.load();
+
+    NotifyWorldRestored();
+
+    return true;
+}
+
+RollbackBenchmark ECSManager::BenchmarkRollback(const unsigned int NumEntities, const unsigned int Iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    ECSManager* const previousActive = Active;
+    RollbackBenchmark result;
+
+    {
+        ECSManager world;
+        world.MakeActive();
+
+        for (unsigned int idx = 0; idx < NumEntities; ++idx)
+        {
+            Entity entity = world.CreateEntity();
+            entity.AddComponent<TransformComponent>(Vector2(static_cast<float>(idx), 0.0f));
+            entity.AddComponent<RigidBodyComponent>(Vector2(1.0f, 0.0f));
+        }
+
+        world.Update(0.0f);
+        world.SaveFrame(0);
+
+        Clock::duration saveTime(0);
+        Clock::duration restoreTime(0);
+
+        for (unsigned int frame = 1; frame <= Iterations; ++frame)
+        {
+            // Every component changes, so no page can be shared with the frame before
+            world.View<TransformComponent, RigidBodyComponent>().Each(
+                [](TransformComponent& Transform, const RigidBodyComponent& RigidBody)
+                {
+                    Transform.Position += RigidBody.Velocity;
+                }
+            );
+
+            const auto saveStart = Clock::now();
+            world.SaveFrame(frame);
+            const auto restoreStart = Clock::now();
+            const bool restored = world.RestoreFrame(frame - 1);
+            const auto restoreEnd = Clock::now();
+
+            saveTime += restoreStart - saveStart;
+            restoreTime += restoreEnd - restoreStart;
+
+            // Moved once per frame from x = ID, so back to x = ID + frame - 1
+            world.View<TransformComponent>().Each(
+                [&result, frame](const Entity& Owner, const TransformComponent& Transform)
+                {
+                    result.Matched = result.Matched && Transform.Position.x == static_cast<float>(Owner.GetID() + frame - 1);
+                }
+            );
+
+            // Carry on from the frame just saved
+            result.Matched = result.Matched && restored && world.RestoreFrame(frame);
+        }
+
+        result.SaveSeconds = std::chrono::duration<double>(saveTime).count();
+        result.RestoreSeconds = std::chrono::duration<double>(restoreTime).count();
+    }
+
+    Active = previousActive;
+
+    return result;
+}
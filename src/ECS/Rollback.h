@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstring>
+
+/**
+ * Read-only copy of one page (or chunk) of component bytes, saved by ECSManager::SaveFrame.
+ * Frames share a page for as long as its bytes stay the same, so saving a frame only costs
+ * a copy of the pages that changed since the frame before it.
+ */
+struct FramePage
+{
+    std::shared_ptr<const unsigned char[]> Bytes;
+    size_t Size = 0;
+
+    /** Copy of the Size bytes at Data, or Previous's bytes if they are exactly the same */
+    static FramePage Capture(const void* Data, const size_t Size, const FramePage* Previous)
+    {
+        if (Previous != nullptr && Previous->Size == Size && std::memcmp(Previous->Bytes.get(), Data, Size) == 0)
+        {
+            return *Previous;
+        }
+
+        std::shared_ptr<unsigned char[]> bytes(new unsigned char[Size]);
+        std::memcpy(bytes.get(), Data, Size);
+
+        return { std::move(bytes), Size };
+    }
+};
+
+/**
+ * Which entity has which slot in a Pool, saved by ECSManager::SaveFrame.
+ * Shared by every frame the pool gained or lost no components in.
+ */
+struct PoolLayout
+{
+    std::vector<unsigned int> EntityIDs;
+    std::vector<unsigned int> Slots;
+    std::vector<unsigned int> FreeSlots;
+    unsigned int NumSlotsUsed = 0;
+};
+
+/** One pool's contents as of some frame, see IPool::SaveFrame */
+class IPoolFrame
+{
+public:
+    virtual ~IPoolFrame() = default;
+};
+
+/** Everything about the world as of some frame, see ECSManager::SaveFrame */
+struct WorldFrame;
+
+/** Timings from ECSManager::BenchmarkRollback, in seconds for the whole run */
+struct RollbackBenchmark
+{
+    double SaveSeconds = 0.0;
+    double RestoreSeconds = 0.0;
+
+    /** Every restore put back exactly the components that were saved */
+    bool Matched = true;
+};
@@ -0,0 +1,251 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "Util/CoreStatics.h"
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include <functional>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SIGNATURE_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SIGNATURE_SIMD_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+/**
+ * One bit per component type. Entities, systems and archetypes are all matched by signature.
+ *
+ * Same interface as the std::bitset this used to be (test/set/reset/any/none and the bitwise
+ * operators), but stored as 64-bit words padded out to whole SIMD registers so that widening
+ * it doesn't slow matching down. Every operation is a handful of AVX2 (or SSE2) instructions:
+ * at the default 256 component types, Contains() is a single load, andnot and test against
+ * each signature - the same cost as the old 32-bit check.
+ */
+class Signature
+{
+public:
+    static constexpr unsigned int NumBits = CoreStatics::MaxNumComponentTypes;
+
+    const bool test(const unsigned int Bit) const
+    {
+        assert(Bit < NumBits);
+        return ((Words[Bit / 64] >> (Bit % 64)) & 1) != 0;
+    }
+
+    Signature& set(const unsigned int Bit, const bool Value = true)
+    {
+        assert(Bit < NumBits);
+        const uint64_t mask = uint64_t(1) << (Bit % 64);
+        Words[Bit / 64] = Value ? (Words[Bit / 64] | mask) : (Words[Bit / 64] & ~mask);
+        return *this;
+    }
+
+    Signature& reset()
+    {
+        *this = Signature();
+        return *this;
+    }
+
+    const bool any() const
+    {
+        Lane acc = LaneZero();
+
+        for (unsigned int word = 0; word < NumWords; word += WordsPerLane)
+        {
+            acc = LaneOr(acc, LaneLoad(Words + word));
+        }
+
+        return LaneIsZero(acc) == false;
+    }
+
+    const bool none() const { return any() == false; }
+
+    /** Whether every bit in Required is also set here, i.e. (*this & Required) == Required in one pass */
+    const bool Contains(const Signature& Required) const
+    {
+        Lane missing = LaneZero();
+
+        for (unsigned int word = 0; word < NumWords; word += WordsPerLane)
+        {
+            missing = LaneOr(missing, LaneAndNot(LaneLoad(Words + word), LaneLoad(Required.Words + word)));
+        }
+
+        return LaneIsZero(missing);
+    }
+
+    /** Whether any bit is set in both, i.e. (*this & Other).any() in one pass */
+    const bool Intersects(const Signature& Other) const
+    {
+        Lane shared = LaneZero();
+
+        for (unsigned int word = 0; word < NumWords; word += WordsPerLane)
+        {
+            shared = LaneOr(shared, LaneAnd(LaneLoad(Words + word), LaneLoad(Other.Words + word)));
+        }
+
+        return LaneIsZero(shared) == false;
+    }
+
+    /** Index of the first set bit at or after From, or NumBits if there isn't one */
+    const unsigned int FindNext(const unsigned int From) const
+    {
+        for (unsigned int word = From / 64; word < NumWords; ++word)
+        {
+            uint64_t bits = Words[word];
+
+            if (word == From / 64)
+            {
+                bits &= ~uint64_t(0) << (From % 64);
+            }
+
+            if (bits != 0)
+            {
+                const unsigned int bit = word * 64 + CountTrailingZeros(bits);
+                return (bit < NumBits) ? bit : NumBits;
+            }
+        }
+
+        return NumBits;
+    }
+
+    const size_t Hash() const
+    {
+        size_t hash = 0;
+
+        for (unsigned int word = 0; word < NumWords; ++word)
+        {
+            hash ^= std::hash<uint64_t>()(Words[word]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+
+        return hash;
+    }
+
+    Signature operator&(const Signature& Other) const { return Combine(Other, LaneAnd); }
+    Signature operator|(const Signature& Other) const { return Combine(Other, LaneOr); }
+
+    /** Also flips the padding bits past NumBits, so only use the result as a mask */
+    Signature operator~() const
+    {
+        Signature result;
+
+        for (unsigned int word = 0; word < NumWords; ++word)
+        {
+            result.Words[word] = ~Words[word];
+        }
+
+        return result;
+    }
+
+    Signature& operator&=(const Signature& Other) { return *this = *this & Other; }
+    Signature& operator|=(const Signature& Other) { return *this = *this | Other; }
+
+    bool operator==(const Signature& Other) const
+    {
+        Lane diff = LaneZero();
+
+        for (unsigned int word = 0; word < NumWords; word += WordsPerLane)
+        {
+            diff = LaneOr(diff, LaneXor(LaneLoad(Words + word), LaneLoad(Other.Words + word)));
+        }
+
+        return LaneIsZero(diff);
+    }
+
+    bool operator!=(const Signature& Other) const { return (*this == Other) == false; }
+
+private:
+#if defined(SIGNATURE_SIMD_AVX2)
+    typedef __m256i Lane;
+    static Lane LaneLoad(const uint64_t* Src) { return _mm256_load_si256(reinterpret_cast<const Lane*>(Src)); }
+    static void LaneStore(uint64_t* Dst, const Lane Value) { _mm256_store_si256(reinterpret_cast<Lane*>(Dst), Value); }
+    static Lane LaneZero() { return _mm256_setzero_si256(); }
+    static Lane LaneAnd(const Lane A, const Lane B) { return _mm256_and_si256(A, B); }
+    static Lane LaneOr(const Lane A, const Lane B) { return _mm256_or_si256(A, B); }
+    static Lane LaneXor(const Lane A, const Lane B) { return _mm256_xor_si256(A, B); }
+    static Lane LaneAndNot(const Lane A, const Lane B) { return _mm256_andnot_si256(A, B); }
+    static bool LaneIsZero(const Lane Value) { return _mm256_testz_si256(Value, Value) != 0; }
+#elif defined(SIGNATURE_SIMD_SSE2)
+    typedef __m128i Lane;
+    static Lane LaneLoad(const uint64_t* Src) { return _mm_load_si128(reinterpret_cast<const Lane*>(Src)); }
+    static void LaneStore(uint64_t* Dst, const Lane Value) { _mm_store_si128(reinterpret_cast<Lane*>(Dst), Value); }
+    static Lane LaneZero() { return _mm_setzero_si128(); }
+    static Lane LaneAnd(const Lane A, const Lane B) { return _mm_and_si128(A, B); }
+    static Lane LaneOr(const Lane A, const Lane B) { return _mm_or_si128(A, B); }
+    static Lane LaneXor(const Lane A, const Lane B) { return _mm_xor_si128(A, B); }
+    static Lane LaneAndNot(const Lane A, const Lane B) { return _mm_andnot_si128(A, B); }
+    static bool LaneIsZero(const Lane Value) { return _mm_movemask_epi8(_mm_cmpeq_epi32(Value, _mm_setzero_si128())) == 0xFFFF; }
+#else
+    typedef uint64_t Lane;
+    static Lane LaneLoad(const uint64_t* Src) { return *Src; }
+    static void LaneStore(uint64_t* Dst, const Lane Value) { *Dst = Value; }
+    static Lane LaneZero() { return 0; }
+    static Lane LaneAnd(const Lane A, const Lane B) { return A & B; }
+    static Lane LaneOr(const Lane A, const Lane B) { return A | B; }
+    static Lane LaneXor(const Lane A, const Lane B) { return A ^ B; }
+    static Lane LaneAndNot(const Lane A, const Lane B) { return ~A & B; }
+    static bool LaneIsZero(const Lane Value) { return Value == 0; }
+#endif
+
+    static constexpr unsigned int WordsPerLane = sizeof(Lane) / sizeof(uint64_t);
+
+    /** Whole lanes' worth of words, so the loops above never need a scalar tail */
+    static constexpr unsigned int NumWords = ((NumBits + 64 * WordsPerLane - 1) / (64 * WordsPerLane)) * WordsPerLane;
+
+    template <typename TOp>
+    Signature Combine(const Signature& Other, TOp&& Op) const
+    {
+        Signature result;
+
+        for (unsigned int word = 0; word < NumWords; word += WordsPerLane)
+        {
+            LaneStore(result.Words + word, Op(LaneLoad(Words + word), LaneLoad(Other.Words + word)));
+        }
+
+        return result;
+    }
+
+    static unsigned int CountTrailingZeros(const uint64_t Bits)
+    {
+#if defined(_MSC_VER)
+        unsigned long idx = 0;
+        _BitScanForward64(&idx, Bits);
+        return static_cast<unsigned int>(idx);
+#else
+        return static_cast<unsigned int>(__builtin_ctzll(Bits));
+#endif
+    }
+
+    alignas(sizeof(Lane)) uint64_t Words[NumWords] = {};
+};
+
+namespace std
+{
+    template <>
+    struct hash<Signature>
+    {
+        size_t operator()(const Signature& InSignature) const { return InSignature.Hash(); }
+    };
+}
+
+/**
+ * Hash for a (from, to) pair of signatures, e.g. to key caches on signature transitions
+ */
+struct SignaturePairHash
+{
+    size_t operator()(const std::pair<Signature, Signature>& Pair) const
+    {
+        const size_t first = Pair.first.Hash();
+        return first ^ (Pair.second.Hash() + 0x9e3779b9 + (first << 6) + (first >> 2));
+    }
+};
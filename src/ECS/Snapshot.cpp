@@ -0,0 +1,671 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "ECS.h"
+#include "CommandBuffer.h"
+#include "Components/TransformComponent.h"
+#include "Components/RigidBodyComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/BoxColliderComponent.h"
+#include "Components/AnimationComponent.h"
+#include "Components/HierarchyComponent.h"
+#include "Components/WorldTransformComponent.h"
+#include <fstream>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * Snapshot layout, every value little-endian as written by SnapshotWriter:
+ *
+ * Header       Magic, Version, NumComponentTypes, NextEntityID, NumFreeIDs, NumSections (uint32 each)
+ * Generations  uint16 per entity ID below NextEntityID
+ * Free IDs     uint32 each, in the order they will be reused
+ * Sections     One per component type anyone has:
+ *              ComponentID, Count, ElementSize, NumDisabled (uint32 each), the Count entity IDs and
+ *              then the NumDisabled ones that have it disabled (uint32 each), DataBytes (uint64) and
+ *              the component data itself - Count raw components of ElementSize bytes, or whatever
+ *              their Serialize wrote if ElementSize is 0.
+ *
+ * Signatures are not stored, they are rebuilt from the sections. That keeps snapshots loadable
+ * whatever the Signature width, as long as ComponentTypes was only ever appended to.
+ */
+struct ComponentSnapshotOps
+{
+    /** Bytes per component if they are saved raw, 0 if each one serializes itself (or is a tag) */
+    uint32_t ElementSize;
+
+    void (ECSManager::*Save)(SnapshotWriter&, const std::vector<unsigned int>&);
+    void (ECSManager::*Load)(SnapshotReader&, const std::vector<unsigned int>&);
+    void (ECSManager::*RegisterInfo)();
+
+    /** Dry run of Load against a copy of the section's reader, true if every component reads back whole */
+    bool (*Check)(SnapshotReader, const unsigned int);
+};
+
+namespace
+{
+    constexpr uint32_t SnapshotMagic = 0x53454432; // "2DES"
+    constexpr uint32_t SnapshotVersion = 2;
+
+    /** Tags have nothing to save, anything else trivially copyable is saved as raw bytes */
+    template <typename TComponent>
+    constexpr bool SavedAsBytes = std::is_trivially_copyable_v<TComponent> && IsTagComponent<TComponent> == false;
+
+    /** Calls Fn with a null TComponents* for every type in the list, all at once */
+    template <typename ...TComponents, typename TFunc>
+    auto ExpandTypeList(TypeList<TComponents...>, TFunc&& Fn)
+    {
+        return Fn(static_cast<TComponents*>(nullptr)...);
+    }
+
+    /**
+     * Read-only view of a whole file, memory-mapped so the OS pages it in as we read
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string& Path)
+        {
+#if defined(_WIN32)
+            File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+            LARGE_INTEGER fileSize;
+
+            if (File == INVALID_HANDLE_VALUE || GetFileSizeEx(File, &fileSize) == FALSE || fileSize.QuadPart == 0)
+            {
+                return;
+            }
+
+            Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if (Mapping != nullptr)
+            {
+                Data = static_cast<const unsigned char*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+                Size = (Data != nullptr) ? static_cast<size_t>(fileSize.QuadPart) : 0;
+            }
+#else
+            File = open(Path.c_str(), O_RDONLY);
+
+            struct stat fileStat;
+
+            if (File < 0 || fstat(File, &fileStat) != 0 || fileStat.st_size == 0)
+            {
+                return;
+            }
+
+            void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+
+            if (mapped != MAP_FAILED)
+            {
+                Data = static_cast<const unsigned char*>(mapped);
+                Size = static_cast<size_t>(fileStat.st_size);
+            }
+#endif
+        }
+
+        ~MappedFile()
+        {
+#if defined(_WIN32)
+            if (Data != nullptr)
+            {
+                UnmapViewOfFile(Data);
+            }
+
+            if (Mapping != nullptr)
+            {
+                CloseHandle(Mapping);
+            }
+
+            if (File != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(File);
+            }
+#else
+            if (Data != nullptr)
+            {
+                munmap(const_cast<unsigned char*>(Data), Size);
+            }
+
+            if (File >= 0)
+            {
+                close(File);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const bool IsOpen() const { return Data != nullptr; }
+        const unsigned char* GetData() const { return Data; }
+        const size_t GetSize() const { return Size; }
+
+    private:
+#if defined(_WIN32)
+        HANDLE File = INVALID_HANDLE_VALUE;
+        HANDLE Mapping = nullptr;
+#else
+        int File = -1;
+#endif
+        const unsigned char* Data = nullptr;
+        size_t Size = 0;
+    };
+
+    /** One component type's part of a snapshot, checked but not yet loaded */
+    struct SnapshotSection
+    {
+        unsigned int ComponentID = 0;
+        std::vector<unsigned int> EntityIDs;
+        std::vector<unsigned int> DisabledIDs;
+        SnapshotReader Data{ nullptr, 0 };
+    };
+
+    /** Reads Count uint32 IDs, which need not be aligned in the file */
+    std::vector<unsigned int> ReadIDs(SnapshotReader& Reader, const uint32_t Count)
+    {
+        std::vector<unsigned int> ids;
+
+        if (Count == 0)
+        {
+            return ids;
+        }
+
+        if (const unsigned char* bytes = Reader.ReadBytes(static_cast<size_t>(Count) * sizeof(uint32_t)))
+        {
+            ids.resize(Count);
+            std::memcpy(ids.data(), bytes, static_cast<size_t>(Count) * sizeof(uint32_t));
+        }
+
+        return ids;
+    }
+
+    template <typename TComponent>
+    bool CheckComponents(SnapshotReader Reader, const unsigned int Count)
+    {
+        // Raw blocks were already checked against Count, only self-serializing components can fail part way
+        if constexpr (SavedAsBytes<TComponent> == false && IsTagComponent<TComponent> == false)
+        {
+            TComponent scratch;
+
+            for (unsigned int idx = 0; idx < Count && Reader.HasFailed() == false; ++idx)
+            {
+                scratch = TComponent();
+                scratch.Deserialize(Reader);
+            }
+        }
+
+        return Reader.HasFailed() == false;
+    }
+}
+
+const std::vector<ComponentSnapshotOps>& ECSManager::GetSnapshotOps()
+{
+    static const std::vector<ComponentSnapshotOps> ops = ExpandTypeList(ComponentTypes(), [](auto* ...Types)
+    {
+        auto makeOps = [](auto* Type)
+        {
+            using TComponent = std::remove_pointer_t<decltype(Type)>;
+
+            return ComponentSnapshotOps{
+                SavedAsBytes<TComponent> ? static_cast<uint32_t>(sizeof(TComponent)) : 0,
+                &ECSManager::SaveComponents<TComponent>,
+                &ECSManager::LoadComponents<TComponent>,
+                &ECSManager::RegisterComponentInfo<TComponent>,
+                &CheckComponents<TComponent>
+            };
+        };
+
+        return std::vector<ComponentSnapshotOps>{ makeOps(Types)... };
+    });
+
+    return ops;
+}
+
+template <typename TComponent>
+void ECSManager::SaveComponents(SnapshotWriter& Writer, const std::vector<unsigned int>& EntityIDs)
+{
+    if constexpr (IsTagComponent<TComponent> == false)
+    {
+        if constexpr (SavedAsBytes<TComponent>)
+        {
+            Writer.Reserve(Writer.Size() + EntityIDs.size() * sizeof(TComponent));
+        }
+
+        for (const unsigned int entityID : EntityIDs)
+        {
+            const TComponent& component = GetComponent<TComponent>(Entity(entityID, EntityGenerations[entityID]));
+
+            if constexpr (SavedAsBytes<TComponent>)
+            {
+                Writer.Write(&component, sizeof(TComponent));
+            }
+            else
+            {
+                component.Serialize(Writer);
+            }
+        }
+    }
+}
+
+template <typename TComponent>
+void ECSManager::LoadComponents(SnapshotReader& Reader, const std::vector<unsigned int>& EntityIDs)
+{
+    constexpr auto componentID = Component<TComponent>::GetID();
+    const auto count = static_cast<unsigned int>(EntityIDs.size());
+
+    RegisterTagComponent<TComponent>();
+
+    if constexpr (IsTagComponent<TComponent> == false)
+    {
+        const unsigned char* block = SavedAsBytes<TComponent> ? Reader.ReadBytes(static_cast<size_t>(count) * sizeof(TComponent)) : nullptr;
+
+        if (StorageMode == EStorageMode::Archetype)
+        {
+            // Rows were already made from the entities' signatures, every column just needs filling in
+            for (unsigned int idx = 0; idx < count; ++idx)
+            {
+                const EntityLocation& location = EntityLocations[EntityIDs[idx]];
+                void* column = location.Owner->GetComponent(componentID, location.Chunk, location.Row);
+
+                if constexpr (SavedAsBytes<TComponent>)
+                {
+                    std::memcpy(column, block + static_cast<size_t>(idx) * sizeof(TComponent), sizeof(TComponent));
+                }
+                else
+                {
+                    // Constructed before reading so a bad file can never leave a row half made
+                    static_cast<TComponent*>(new (column) TComponent())->Deserialize(Reader);
+                }
+            }
+        }
+        else if constexpr (SavedAsBytes<TComponent>)
+        {
+            GetOrCreateComponentPool<TComponent>()->Adopt(EntityIDs.data(), block, count);
+        }
+        else
+        {
+            Pool<TComponent>* pool = GetOrCreateComponentPool<TComponent>();
+            pool->Reserve(count);
+
+            for (const unsigned int entityID : EntityIDs)
+            {
+                pool->Emplace(entityID).Deserialize(Reader);
+            }
+        }
+    }
+
+    if (count > 0)
+    {
+        ResizeChangeStorage(componentID, *std::max_element(EntityIDs.begin(), EntityIDs.end()));
+
+        for (const unsigned int entityID : EntityIDs)
+        {
+            StampChange(componentID, entityID);
+        }
+
+        ComponentTypeVersions[componentID] = ChangeVersion.load();
+    }
+}
+
+const bool ECSManager::SaveSnapshot(const std::string& Path)
+{
+    const std::vector<ComponentSnapshotOps>& ops = GetSnapshotOps();
+
+    if (NextEntityID > 0)
+    {
+        // Command buffers can hand out IDs before storage exists for them
+        ResizeEntityStorage(NextEntityID - 1);
+    }
+
+    // Killed entities still waiting for Update to clear them out are saved as already gone
+    std::vector<unsigned int> freeIDs;
+    std::vector<bool> dead(NextEntityID, false);
+
+    for (std::queue<unsigned int> pending = FreeEntityIDs; pending.empty() == false; pending.pop())
+    {
+        freeIDs.push_back(pending.front());
+    }
+
+    for (const Entity& entity : EntitiesToBeRemoved)
+    {
+        freeIDs.push_back(entity.GetID());
+        dead[entity.GetID()] = true;
+    }
+
+    std::vector<std::vector<unsigned int>> entitiesByType(ops.size());
+    std::vector<std::vector<unsigned int>> disabledByType(ops.size());
+
+    for (unsigned int entityID = 0; entityID < NextEntityID; ++entityID)
+    {
+        if (dead[entityID])
+        {
+            continue;
+        }
+
+        const Signature& signature = EntityComponentSignatures[entityID];
+
+        for (unsigned int componentID = signature.FindNext(0); componentID < Signature::NumBits; componentID = signature.FindNext(componentID + 1))
+        {
+            entitiesByType[componentID].push_back(entityID);
+
+            if (DisabledComponents[entityID].test(componentID))
+            {
+                disabledByType[componentID].push_back(entityID);
+            }
+        }
+    }
+
+    uint32_t numSections = 0;
+
+    for (const std::vector<unsigned int>& entityIDs : entitiesByType)
+    {
+        numSections += entityIDs.empty() ? 0 : 1;
+    }
+
+    SnapshotWriter writer;
+    writer.Write(SnapshotMagic);
+    writer.Write(SnapshotVersion);
+    writer.Write(static_cast<uint32_t>(ops.size()));
+    writer.Write(static_cast<uint32_t>(NextEntityID));
+    writer.Write(static_cast<uint32_t>(freeIDs.size()));
+    writer.Write(numSections);
+
+    static_assert(sizeof(EntityGenerations[0]) == sizeof(uint16_t), "Generations are saved as 16 bits");
+    writer.Write(EntityGenerations.data(), NextEntityID * sizeof(uint16_t));
+    writer.Write(freeIDs.data(), freeIDs.size() * sizeof(uint32_t));
+
+    for (unsigned int componentID = 0; componentID < ops.size(); ++componentID)
+    {
+        const std::vector<unsigned int>& entityIDs = entitiesByType[componentID];
+        const std::vector<unsigned int>& disabledIDs = disabledByType[componentID];
+
+        if (entityIDs.empty())
+        {
+            continue;
+        }
+
+        writer.Write(static_cast<uint32_t>(componentID));
+        writer.Write(static_cast<uint32_t>(entityIDs.size()));
+        writer.Write(ops[componentID].ElementSize);
+        writer.Write(static_cast<uint32_t>(disabledIDs.size()));
+        writer.Write(entityIDs.data(), entityIDs.size() * sizeof(uint32_t));
+        writer.Write(disabledIDs.data(), disabledIDs.size() * sizeof(uint32_t));
+
+        // Filled in once the components are written
+        const size_t dataBytesOffset = writer.Size();
+        writer.Write(static_cast<uint64_t>(0));
+
+        (this->*ops[componentID].Save)(writer, entityIDs);
+
+        writer.WriteAt(dataBytesOffset, static_cast<uint64_t>(writer.Size() - dataBytesOffset - sizeof(uint64_t)));
+    }
+
+    std::ofstream file(Path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(writer.GetBuffer().data()), static_cast<std::streamsize>(writer.Size()));
+
+    if (file.good() == false)
+    {
+        Logger::LogError("Failed to write snapshot " + Path);
+        return false;
+    }
+
+    return true;
+}
+
+const bool ECSManager::LoadSnapshot(const std::string& Path)
+{
+    const std::vector<ComponentSnapshotOps>& ops = GetSnapshotOps();
+    const MappedFile file(Path);
+
+    if (file.IsOpen() == false)
+    {
+        Logger::LogError("Failed to open snapshot " + Path);
+        return false;
+    }
+
+    SnapshotReader reader(file.GetData(), file.GetSize());
+
+    const auto magic = reader.Read<uint32_t>();
+    const auto version = reader.Read<uint32_t>();
+    const auto numComponentTypes = reader.Read<uint32_t>();
+    const auto nextEntityID = reader.Read<uint32_t>();
+    const auto numFreeIDs = reader.Read<uint32_t>();
+    const auto numSections = reader.Read<uint32_t>();
+
+    if (magic != SnapshotMagic || version != SnapshotVersion)
+    {
+        Logger::LogError("Not a snapshot, or one from an unsupported version: " + Path);
+        return false;
+    }
+
+    bool valid = numComponentTypes <= ops.size() && nextEntityID <= CoreStatics::MaxNumEntities && numFreeIDs <= nextEntityID;
+
+    const unsigned char* generations = valid ? reader.ReadBytes(static_cast<size_t>(nextEntityID) * sizeof(uint16_t)) : nullptr;
+    const std::vector<unsigned int> freeIDs = valid ? ReadIDs(reader, numFreeIDs) : std::vector<unsigned int>();
+
+    // Check the whole file, dry-running every section's components, before touching the world so a bad one leaves it as it was.
+    // Marks is reused to catch duplicate IDs: free IDs first, then each section's entities.
+    std::vector<unsigned int> marks(nextEntityID, 0);
+    std::vector<bool> isFree(nextEntityID, false);
+    std::vector<bool> seenComponent(ops.size(), false);
+    std::vector<SnapshotSection> sections;
+
+    for (const unsigned int entityID : freeIDs)
+    {
+        valid = valid && entityID < nextEntityID && isFree[entityID] == false;
+
+        if (valid)
+        {
+            isFree[entityID] = true;
+        }
+    }
+
+    for (uint32_t sectionIdx = 0; valid && sectionIdx < numSections; ++sectionIdx)
+    {
+        SnapshotSection& section = sections.emplace_back();
+        section.ComponentID = reader.Read<uint32_t>();
+
+        const auto count = reader.Read<uint32_t>();
+        const auto elementSize = reader.Read<uint32_t>();
+        const auto numDisabled = reader.Read<uint32_t>();
+
+        valid = reader.HasFailed() == false &&
+            section.ComponentID < numComponentTypes &&
+            seenComponent[section.ComponentID] == false &&
+            elementSize == ops[section.ComponentID].ElementSize &&
+            count <= nextEntityID && numDisabled <= count;
+
+        if (valid == false)
+        {
+            break;
+        }
+
+        seenComponent[section.ComponentID] = true;
+        section.EntityIDs = ReadIDs(reader, count);
+        section.DisabledIDs = ReadIDs(reader, numDisabled);
+
+        for (const unsigned int entityID : section.EntityIDs)
+        {
+            valid = valid && entityID < nextEntityID && isFree[entityID] == false && marks[entityID] != sectionIdx + 1;
+
+            if (valid)
+            {
+                marks[entityID] = sectionIdx + 1;
+            }
+        }
+
+        for (const unsigned int entityID : section.DisabledIDs)
+        {
+            valid = valid && entityID < nextEntityID && marks[entityID] == sectionIdx + 1;
+        }
+
+        const auto dataBytes = reader.Read<uint64_t>();
+        valid = valid && (elementSize == 0 || dataBytes == static_cast<uint64_t>(count) * elementSize) && dataBytes <= reader.GetRemaining();
+
+        if (valid)
+        {
+            section.Data = SnapshotReader(reader.ReadBytes(static_cast<size_t>(dataBytes)), static_cast<size_t>(dataBytes));
+            valid = ops[section.ComponentID].Check(section.Data, count);
+        }
+    }
+
+    if (valid == false || reader.HasFailed())
+    {
+        Logger::LogError("Snapshot is corrupt: " + Path);
+        return false;
+    }
+
+    ClearWorld();
+
+    if (nextEntityID > 0)
+    {
+        ResizeEntityStorage(nextEntityID - 1);
+        std::memcpy(EntityGenerations.data(), generations, static_cast<size_t>(nextEntityID) * sizeof(uint16_t));
+    }
+
+    NextEntityID = nextEntityID;
+    NumEntities = nextEntityID - numFreeIDs;
+
+    for (const unsigned int entityID : freeIDs)
+    {
+        FreeEntityIDs.push(entityID);
+    }
+
+    for (const SnapshotSection& section : sections)
+    {
+        for (const unsigned int entityID : section.EntityIDs)
+        {
+            EntityComponentSignatures[entityID].set(section.ComponentID);
+        }
+
+        for (const unsigned int entityID : section.DisabledIDs)
+        {
+            SetDisabledBit(entityID, section.ComponentID, true);
+        }
+    }
+
+    if (StorageMode == EStorageMode::Archetype)
+    {
+        for (const SnapshotSection& section : sections)
+        {
+            (this->*ops[section.ComponentID].RegisterInfo)();
+        }
+
+        // Entities with the same components tend to be created (and so saved) together
+        Archetype* archetype = nullptr;
+
+        for (unsigned int entityID = 0; entityID < NextEntityID; ++entityID)
+        {
+            const Signature& signature = EntityComponentSignatures[entityID];
+
+            if (signature.none())
+            {
+                continue;
+            }
+
+            if (archetype == nullptr || archetype->GetSignature() != signature)
+            {
+                archetype = FindOrCreateArchetype(signature);
+            }
+
+            EntityLocations[entityID] = archetype->AddRow(entityID);
+        }
+    }
+
+    // Every section already read back whole in its dry run
+    for (SnapshotSection& section : sections)
+    {
+        (this->*ops[section.ComponentID].Load)(section.Data, section.EntityIDs);
+        assert(section.Data.HasFailed() == false);
+    }
+
+    // Join systems and views a whole signature's worth of entities at a time
+    std::unordered_map<Signature, std::vector<Entity>> entitiesBySignature;
+
+    for (unsigned int entityID = 0; entityID < NextEntityID; ++entityID)
+    {
+        if (isFree[entityID] == false)
+        {
+            entitiesBySignature[GetEnabledSignature(entityID)].push_back(Entity(entityID, EntityGenerations[entityID]));
+        }
+    }
+
+    for (const auto& [signature, entities] : entitiesBySignature)
+    {
+        AddEntitiesToSystems(entities, signature);
+    }
+
+    NotifyWorldRestored();
+
+    return true;
+}
+
+void ECSManager::ClearWorld()
+{
+    DropSavedFrames();
+    MarkLayoutChanged();
+
+    for (System* system : SystemOrder)
+    {
+        system->Entities.clear();
+        system->EntityIDs.Clear();
+    }
+
+    for (auto& [required, cache] : ViewCaches)
+    {
+        cache.EntityIDs.Clear();
+    }
+
+    for (IPool* pool : ComponentPools)
+    {
+        if (pool != nullptr)
+        {
+            pool->Clear();
+        }
+    }
+
+    for (Archetype* archetype : ArchetypeList)
+    {
+        delete archetype;
+    }
+
+    Archetypes.clear();
+    ArchetypeList.clear();
+    std::fill(EntityLocations.begin(), EntityLocations.end(), EntityLocation());
+
+    std::fill(EntityComponentSignatures.begin(), EntityComponentSignatures.end(), Signature());
+    std::fill(DisabledComponents.begin(), DisabledComponents.end(), Signature());
+    std::fill(NumDisabled.begin(), NumDisabled.end(), 0);
+    DisabledTypes.reset();
+
+    std::fill(EntityGenerations.begin(), EntityGenerations.end(), 0);
+    FreeEntityIDs = std::queue<unsigned int>();
+    NextEntityID = 0;
+    NumEntities = 0;
+    EntitiesToBeAdded.clear();
+    EntitiesToBeRemoved.clear();
+
+    for (ComponentObservers& observers : Observers)
+    {
+        observers.Added.clear();
+        observers.Removed.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(CommandBufferMutex);
+
+    for (auto& [thread, buffer] : CommandBuffers)
+    {
+        buffer->Clear();
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Appends raw bytes for a world snapshot (see ECSManager::SaveSnapshot).
+ * Components that are not trivially copyable write themselves out with this, e.g.
+ * void Serialize(SnapshotWriter& Writer) const { Writer.WriteString(AssetID); Writer.Write(Width); }
+ */
+class SnapshotWriter
+{
+public:
+    void Reserve(const size_t Capacity) { Buffer.reserve(Capacity); }
+
+    void Write(const void* Data, const size_t Size)
+    {
+        const size_t offset = Buffer.size();
+        Buffer.resize(offset + Size);
+
+        if (Size > 0)
+        {
+            std::memcpy(Buffer.data() + offset, Data, Size);
+        }
+    }
+
+    template <typename T>
+    void Write(const T& Value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be written as bytes");
+        Write(&Value, sizeof(T));
+    }
+
+    void WriteString(const std::string& Value)
+    {
+        Write(static_cast<uint32_t>(Value.size()));
+        Write(Value.data(), Value.size());
+    }
+
+    /** Overwrites bytes already written, e.g. to fill in a size once it is known */
+    template <typename T>
+    void WriteAt(const size_t Offset, const T& Value)
+    {
+        std::memcpy(Buffer.data() + Offset, &Value, sizeof(T));
+    }
+
+    const size_t Size() const { return Buffer.size(); }
+    const std::vector<unsigned char>& GetBuffer() const { return Buffer; }
+
+private:
+    std::vector<unsigned char> Buffer;
+};
+
+/**
+ * Reads back what a SnapshotWriter wrote, straight out of memory (usually a mapped file).
+ * Reading past the end fails the reader rather than overrunning: every later read gives back
+ * zeros/empty values and HasFailed() turns true.
+ */
+class SnapshotReader
+{
+public:
+    SnapshotReader(const unsigned char* InData, const size_t InSize) : Data(InData), Size(InSize) {}
+
+    /** The next NumBytes bytes, or nullptr if there aren't that many left */
+    const unsigned char* ReadBytes(const size_t NumBytes)
+    {
+        if (Failed || NumBytes > Size - Offset)
+        {
+            Failed = true;
+            return nullptr;
+        }
+
+        const unsigned char* bytes = Data + Offset;
+        Offset += NumBytes;
+
+        return bytes;
+    }
+
+    template <typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be read as bytes");
+
+        T value{};
+
+        if (const unsigned char* bytes = ReadBytes(sizeof(T)))
+        {
+            std::memcpy(&value, bytes, sizeof(T));
+        }
+
+        return value;
+    }
+
+    template <typename T>
+    void Read(T& Value)
+    {
+        Value = Read<T>();
+    }
+
+    std::string ReadString()
+    {
+        const auto length = Read<uint32_t>();
+        const unsigned char* bytes = ReadBytes(length);
+
+        return (bytes != nullptr) ? std::string(reinterpret_cast<const char*>(bytes), length) : std::string();
+    }
+
+    const bool HasFailed() const { return Failed; }
+    const size_t GetOffset() const { return Offset; }
+    const size_t GetRemaining() const { return Size - Offset; }
+
+private:
+    const unsigned char* Data;
+    size_t Size;
+    size_t Offset = 0;
+    bool Failed = false;
+};
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "SparseSet.h"
+#include <cassert>
+
+void SparseSet::Clear()
+{
+    Dense.clear();
+    SparsePages.clear();
+}
+
+void SparseSet::Assign(const std::vector<unsigned int>& IDs)
+{
+    for (const unsigned int id : Dense)
+    {
+        SparsePages[id / PageSize][id % PageSize] = NullIndex;
+    }
+
+    Dense = IDs;
+
+    for (unsigned int idx = 0; idx < Dense.size(); ++idx)
+    {
+        SparseSlot(Dense[idx]) = idx;
+    }
+}
+
+const unsigned int SparseSet::IndexOf(const unsigned int ID) const
+{
+    const auto page = ID / PageSize;
+
+    if (page < SparsePages.size() && SparsePages[page].empty() == false)
+    {
+        return SparsePages[page][ID % PageSize];
+    }
+
+    return NullIndex;
+}
+
+unsigned int SparseSet::Insert(const unsigned int ID)
+{
+    assert(Contains(ID) == false);
+
+    const auto idx = static_cast<unsigned int>(Dense.size());
+    Dense.push_back(ID);
+    SparseSlot(ID) = idx;
+
+    return idx;
+}
+
+unsigned int SparseSet::Remove(const unsigned int ID)
+{
+    const auto idx = IndexOf(ID);
+
+    if (idx != NullIndex)
+    {
+        const auto lastID = Dense.back();
+        Dense[idx] = lastID;
+        SparseSlot(lastID) = idx;
+
+        Dense.pop_back();
+        SparseSlot(ID) = NullIndex;
+    }
+
+    return idx;
+}
+
+unsigned int& SparseSet::SparseSlot(const unsigned int ID)
+{
+    const auto page = ID / PageSize;
+
+    if (page >= SparsePages.size())
+    {
+        SparsePages.resize(page + 1);
+    }
+
+    // Pages are allocated lazily, only for ranges of IDs that are actually used
+    if (SparsePages[page].empty())
+    {
+        SparsePages[page].resize(PageSize, NullIndex);
+    }
+
+    return SparsePages[page][ID % PageSize];
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "Util/CoreStatics.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * Sparse set of entity IDs.
+ * Dense is a packed array of every ID in the set, Sparse maps an ID back to its index
+ * in Dense. Sparse is split into fixed-size pages that are only allocated once an ID
+ * in their range is inserted, so a handful of high IDs does not cost a full-size array.
+ *
+ * Insert, Remove and Contains are all O(1). Remove swaps the last element into the
+ * removed slot, so anything stored in parallel to Dense must do the same swap.
+ */
+class SparseSet
+{
+public:
+    static constexpr unsigned int NullIndex = static_cast<unsigned int>(-1);
+
+    const bool Empty() const { return Dense.empty(); }
+    const size_t Size() const { return Dense.size(); }
+    void Reserve(const size_t Capacity) { Dense.reserve(Capacity); }
+    void Clear();
+
+    const bool Contains(const unsigned int ID) const { return IndexOf(ID) != NullIndex; }
+
+    /** Index of ID in the dense array, or NullIndex if ID is not in the set. */
+    const unsigned int IndexOf(const unsigned int ID) const;
+
+    /** Adds ID to the back of the dense array and returns its index. ID must not already be present. */
+    unsigned int Insert(const unsigned int ID);
+
+    /**
+     * Swaps ID with the last element and pops it.
+     * Returns the index ID used to occupy, or NullIndex if it was not present.
+     */
+    unsigned int Remove(const unsigned int ID);
+
+    const std::vector<unsigned int>& GetDense() const { return Dense; }
+
+    /** Replaces the contents with IDs, in that order. Cheaper than Clear() and inserting each, since no pages are freed. */
+    void Assign(const std::vector<unsigned int>& IDs);
+
+private:
+    static constexpr unsigned int PageSize = CoreStatics::SparsePageSize;
+
+    unsigned int& SparseSlot(const unsigned int ID);
+
+    std::vector<unsigned int> Dense;
+    std::vector<std::vector<unsigned int>> SparsePages;
+};
\ No newline at end of file
@@ -12,36 +12,40 @@ AnimationSystem::AnimationSystem()
 {
     RequireComponent<SpriteComponent>();
     RequireComponent<AnimationComponent>();
+
+    WritesComponent<SpriteComponent>();
+    WritesComponent<AnimationComponent>();
 }
 
 void AnimationSystem::Update(const float DeltaTime)
 {
-    for (const Entity& entity : GetEntities())
-    {
-        auto& animation = entity.GetComponent<AnimationComponent>();
-
-        if (animation.ShouldLoop == false && animation.CurrentFrame >= animation.NumFrames)
-        {
-            continue;
-        }
-
-        if (CoreStatics::Now() >= animation.NextFrameUpdateTime)
+    // Timed by DeltaTime rather than the clock, so re-simulating after RestoreFrame plays out the same
+    GetOwner()->View<AnimationComponent, SpriteComponent>().ParallelEach(CoreStatics::ParallelChunkSize,
+        [DeltaTime](AnimationComponent& Animation, SpriteComponent& Sprite)
         {
-            auto& sprite = entity.GetComponent<SpriteComponent>();
-
-            // CurrentFrame - 1 because the origin is 0, 0 and frames are not zero-indexed
-            sprite.SourceRect.x = sprite.Width * (animation.CurrentFrame - 1);
-
-            if (animation.CurrentFrame < animation.NumFrames)
+            if (Animation.ShouldLoop == false && Animation.CurrentFrame >= Animation.NumFrames)
             {
-                ++animation.CurrentFrame;
+                return;
             }
-            else
+
+            Animation.ElapsedTime += DeltaTime;
+
+            if (Animation.ElapsedTime >= Animation.NextFrameUpdateTime)
             {
-                animation.CurrentFrame = 1;
+                // CurrentFrame - 1 because the origin is 0, 0 and frames are not zero-indexed
+                Sprite.SourceRect.x = Sprite.Width * (Animation.CurrentFrame - 1);
+
+                if (Animation.CurrentFrame < Animation.NumFrames)
+                {
+                    ++Animation.CurrentFrame;
+                }
+                else
+                {
+                    Animation.CurrentFrame = 1;
+                }
+
+                Animation.NextFrameUpdateTime += Animation.SecondsPerFrame;
             }
-
-            animation.NextFrameUpdateTime += animation.SecondsPerFrame;
         }
-    }
+    );
 }
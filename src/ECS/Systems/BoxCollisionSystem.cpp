@@ -9,82 +9,361 @@
 #include "ECS/Components/RigidBodyComponent.h"
 #include "Game/Game.h"
 #include "EventBus/EventBus.h"
-#include "Event/CollisionEvent.h"
+#include <algorithm>
 
-BoxCollisionSystem::BoxCollisionSystem()
+namespace
+{
+    uint64_t ContactKey(const Entity& A, const Entity& B)
+    {
+        const uint64_t lesser = std::min(A.GetHandle(), B.GetHandle());
+        const uint64_t greater = std::max(A.GetHandle(), B.GetHandle());
+
+        return (lesser << 32) | greater;
+    }
+
+    Entity EntityFromHandle(const uint32_t Handle)
+    {
+        return Entity(Handle & Entity::IndexMask, Handle >> Entity::IndexBits);
+    }
+
+    Contact ContactFromKey(const uint64_t Key)
+    {
+        return { EntityFromHandle(static_cast<uint32_t>(Key >> 32)), EntityFromHandle(static_cast<uint32_t>(Key)) };
+    }
+}
+
+BoxCollisionSystem::BoxCollisionSystem(const EBroadphase InBroadphase)
+    : Broadphase(InBroadphase)
 {
     RequireComponent<TransformComponent>();
     RequireComponent<BoxColliderComponent>();
 }
 
 void BoxCollisionSystem::Update(const float DeltaTime)
+{
+    FindContacts();
+    EmitContactEvents();
+
+    std::swap(ContactKeys, NewContactKeys);
+}
+
+void BoxCollisionSystem::OnWorldRestored()
+{
+    // Whatever was touching began before the restored frame, so it only ever stays or ends from here
+    FindContacts();
+
+    std::swap(ContactKeys, NewContactKeys);
+}
+
+void BoxCollisionSystem::FindContacts()
 {
     const auto& entities = GetEntities();
 
-    for (size_t i = 0; i < entities.size(); i++)
+    Bounds.resize(entities.size());
+
+    for (size_t idx = 0; idx < entities.size(); ++idx)
     {
-        for (size_t j = i + 1; j < entities.size(); j++)
-        {
-            const Entity& a = entities.at(i);
-            const Entity& b = entities.at(j);
-            
-            const unsigned int aID = a.GetID();
-            const unsigned int bID = b.GetID();
+        const auto& box = entities[idx].GetComponent<BoxColliderComponent>();
+        const auto& transform = entities[idx].GetComponent<TransformComponent>();
+
+        Bounds[idx] = box.GetBounds(transform.Position);
+    }
 
-            auto& aBox = a.GetComponent<BoxColliderComponent>();
-            auto& bBox = b.GetComponent<BoxColliderComponent>();
+    UpdateTree();
 
-            const auto& aTransform = a.GetComponent<TransformComponent>();
-            const auto& bTransform = b.GetComponent<TransformComponent>();
+    // Broadphase: only colliders near each other can overlap
+    Candidates.clear();
 
-            const bool alreadyColliding = aBox.IsCollidingWith(bID) && bBox.IsCollidingWith(aID);
+    if (Broadphase == EBroadphase::AABBTree)
+    {
+        for (size_t idx = 0; idx < entities.size(); ++idx)
+        {
+            const unsigned int id = entities[idx].GetID();
 
-            // Are objects overlapping?
-            if (DetectCollision(aBox, bBox, aTransform, bTransform))
+            // Both colliders find each other, only keep the pair from the lower ID's side
+            Tree.Query(Bounds[idx], [&](const unsigned int Proxy)
             {
-                // Have we handled this collision yet?
-                if (alreadyColliding == false)
+                const unsigned int otherID = Tree.GetUserData(Proxy);
+
+                if (id < otherID)
                 {
-                    aBox.AddCollision(bID);
-                    bBox.AddCollision(aID);
-                    HandleCollision(a, b);
+                    Candidates.emplace_back(static_cast<unsigned int>(idx), EntityIDs.IndexOf(otherID));
                 }
-            }
-            // Collision handled in previous frame, objects no longer overlapping
-            else if (alreadyColliding)
-            {
-                aBox.RemoveCollision(bID);
-                bBox.RemoveCollision(aID);
-            }
+
+                return true;
+            });
+        }
+    }
+    else if (Broadphase == EBroadphase::SweepAndPrune)
+    {
+        for (size_t idx = 0; idx < entities.size(); ++idx)
+        {
+            Sweep.SetBounds(entities[idx].GetID(), Bounds[idx]);
+        }
+
+        // Proxies are keyed by entity ID, turn them back into indices into entities
+        Sweep.FindPairs(Candidates);
+
+        for (auto& [i, j] : Candidates)
+        {
+            i = EntityIDs.IndexOf(i);
+            j = EntityIDs.IndexOf(j);
         }
     }
+    else
+    {
+        Grid.Build(Bounds);
+        Grid.FindPairs(Candidates);
+    }
+
+    DetectCollisions();
+
+    std::sort(NewContactKeys.begin(), NewContactKeys.end());
 }
 
-const bool BoxCollisionSystem::DetectCollision(
-    const BoxColliderComponent& ABox, const BoxColliderComponent& BBox,
-    const TransformComponent& ATransform, const TransformComponent& BTransform)
+void BoxCollisionSystem::EmitContactEvents()
 {
-    const auto aMinX = ATransform.Position.x + ABox.Offset.x;
-    const auto aMaxX = aMinX + ABox.Width;
-    const auto bMinX = BTransform.Position.x + ABox.Offset.x;
-    const auto bMaxX = bMinX + BBox.Width;
-    const auto aMinY = ATransform.Position.y + ABox.Offset.y;
-    const auto aMaxY = aMinY + ABox.Width;
-    const auto bMinY = BTransform.Position.y + ABox.Offset.y;
-    const auto bMaxY = bMinY + BBox.Width;
-
-    return (
-        aMinX < bMaxX &&
-        bMinX < aMaxX &&
-        aMinY < bMaxY &&
-        bMinY < aMaxY
-    );
+    BeganContacts.clear();
+    StayedContacts.clear();
+    EndedContacts.clear();
+
+    // Both lists are sorted, so one walk over them splits every contact into its phase
+    size_t oldIdx = 0;
+    size_t newIdx = 0;
+
+    while (oldIdx < ContactKeys.size() && newIdx < NewContactKeys.size())
+    {
+        const uint64_t oldKey = ContactKeys[oldIdx];
+        const uint64_t newKey = NewContactKeys[newIdx];
+
+        if (oldKey < newKey)
+        {
+            EndedContacts.push_back(ContactFromKey(oldKey));
+            ++oldIdx;
+        }
+        else if (newKey < oldKey)
+        {
+            BeganContacts.push_back(ContactFromKey(newKey));
+            ++newIdx;
+        }
+        else
+        {
+            StayedContacts.push_back(ContactFromKey(newKey));
+            ++oldIdx;
+            ++newIdx;
+        }
+    }
+
+    for (; oldIdx < ContactKeys.size(); ++oldIdx)
+    {
+        EndedContacts.push_back(ContactFromKey(ContactKeys[oldIdx]));
+    }
+
+    for (; newIdx < NewContactKeys.size(); ++newIdx)
+    {
+        BeganContacts.push_back(ContactFromKey(NewContactKeys[newIdx]));
+    }
+
+    if (auto* eventManager = Game::GetEventManager())
+    {
+        if (EndedContacts.empty() == false)
+        {
+            eventManager->EmitEvent<ContactEndEvent>(EndedContacts);
+        }
+
+        if (StayedContacts.empty() == false)
+        {
+            eventManager->EmitEvent<ContactStayEvent>(StayedContacts);
+        }
+
+        if (BeganContacts.empty() == false)
+        {
+            eventManager->EmitEvent<ContactBeginEvent>(BeganContacts);
+        }
+    }
 }
 
-void BoxCollisionSystem::HandleCollision(const Entity& A, const Entity& B)
+const bool BoxCollisionSystem::IsTouching(const Entity A, const Entity B) const
 {
-    if (auto* eventManager = Game::GetEventManager())
+    return std::binary_search(ContactKeys.begin(), ContactKeys.end(), ContactKey(A, B));
+}
+
+void BoxCollisionSystem::UpdateTree()
+{
+    const auto& entities = GetEntities();
+
+    // Entities that left the system since the last update
+    for (size_t idx = 0; idx < ProxyIDs.size();)
     {
-        eventManager->EmitEvent<CollisionEvent>(A, B);
+        const unsigned int id = ProxyIDs[idx];
+
+        if (EntityIDs.Contains(id))
+        {
+            ++idx;
+            continue;
+        }
+
+        Tree.DestroyProxy(TreeProxies[id]);
+        TreeProxies[id] = AABBTree::NullNode;
+        ProxyIDs[idx] = ProxyIDs.back();
+        ProxyIDs.pop_back();
     }
-}
\ No newline at end of file
+
+    for (size_t idx = 0; idx < entities.size(); ++idx)
+    {
+        const unsigned int id = entities[idx].GetID();
+
+        if (id >= TreeProxies.size())
+        {
+            TreeProxies.resize(id + 1, AABBTree::NullNode);
+        }
+
+        if (TreeProxies[id] == AABBTree::NullNode)
+        {
+            TreeProxies[id] = Tree.CreateProxy(Bounds[idx], id);
+            ProxyIDs.push_back(id);
+        }
+        else
+        {
+            Tree.MoveProxy(TreeProxies[id], Bounds[idx]);
+        }
+    }
+}
+
+const Entity* BoxCollisionSystem::FindProxyEntity(const unsigned int Proxy) const
+{
+    const unsigned int idx = EntityIDs.IndexOf(Tree.GetUserData(Proxy));
+    return (idx == SparseSet::NullIndex) ? nullptr : &Entities[idx];
+}
+
+std::vector<Entity> BoxCollisionSystem::QueryAABB(const AABB& Bounds) const
+{
+    std::vector<Entity> found;
+
+    Tree.Query(Bounds, [&](const unsigned int Proxy)
+    {
+        const Entity* entity = FindProxyEntity(Proxy);
+
+        if (entity != nullptr && Tree.GetBounds(Proxy).Overlaps(Bounds))
+        {
+            found.push_back(*entity);
+        }
+
+        return true;
+    });
+
+    return found;
+}
+
+std::vector<Entity> BoxCollisionSystem::QueryPoint(const Vector2 Point) const
+{
+    std::vector<Entity> found;
+
+    Tree.QueryPoint(Point, [&](const unsigned int Proxy)
+    {
+        const Entity* entity = FindProxyEntity(Proxy);
+
+        if (entity != nullptr && Tree.GetBounds(Proxy).Contains(Point))
+        {
+            found.push_back(*entity);
+        }
+
+        return true;
+    });
+
+    return found;
+}
+
+const bool BoxCollisionSystem::Raycast(const Vector2 Origin, const Vector2 Direction, 
+    const float MaxDistance, RaycastHit& OutHit) const
+{
+    if (MaxDistance <= 0.0f || glm::dot(Direction, Direction) == 0.0f)
+    {
+        return false;
+    }
+
+    const Vector2 delta = glm::normalize(Direction) * MaxDistance;
+    const Entity* closest = nullptr;
+    float closestFraction = 1.0f;
+
+    Tree.Raycast(Origin, delta, [&](const unsigned int Proxy, const float MaxFraction)
+    {
+        const Entity* entity = FindProxyEntity(Proxy);
+        float fraction = MaxFraction;
+
+        if (entity == nullptr || Tree.GetBounds(Proxy).Raycast(Origin, delta, fraction) == false)
+        {
+            return MaxFraction;
+        }
+
+        closest = entity;
+        closestFraction = fraction;
+        return fraction;
+    });
+
+    if (closest == nullptr)
+    {
+        return false;
+    }
+
+    OutHit.HitEntity = *closest;
+    OutHit.Point = Origin + delta * closestFraction;
+    OutHit.Distance = MaxDistance * closestFraction;
+
+    return true;
+}
+
+void BoxCollisionSystem::DetectCollisions()
+{
+    const auto& entities = GetEntities();
+
+    // Counting sort each candidate's second collider into its first collider's partner list.
+    // Filling bumps each start up to the next one, so afterwards collider i's partners run
+    // from PartnerStarts[i - 1] (or 0) to PartnerStarts[i].
+    PartnerStarts.assign(entities.size() + 1, 0);
+    Partners.resize(Candidates.size());
+    Hits.resize(Candidates.size());
+
+    for (const auto& [i, j] : Candidates)
+    {
+        ++PartnerStarts[i + 1];
+    }
+
+    for (size_t idx = 0; idx < entities.size(); ++idx)
+    {
+        PartnerStarts[idx + 1] += PartnerStarts[idx];
+    }
+
+    for (const auto& [i, j] : Candidates)
+    {
+        Partners[PartnerStarts[i]++] = j;
+    }
+
+    NewContactKeys.clear();
+
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        const unsigned int first = (i == 0) ? 0 : PartnerStarts[i - 1];
+        const unsigned int last = PartnerStarts[i];
+
+        if (first == last)
+        {
+            continue;
+        }
+
+        // Pack the partners' bounds together so the kernel can test them 8 (or 4) at a time
+        PartnerBounds.Clear();
+
+        for (unsigned int partner = first; partner < last; ++partner)
+        {
+            PartnerBounds.Push(Bounds[Partners[partner]]);
+        }
+
+        const size_t numHits = PartnerBounds.FindOverlaps(Bounds[i], Hits.data());
+
+        for (size_t hit = 0; hit < numHits; ++hit)
+        {
+            NewContactKeys.push_back(ContactKey(entities[i], entities[Partners[first + Hits[hit]]]));
+        }
+    }
+}
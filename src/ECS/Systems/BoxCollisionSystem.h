@@ -6,19 +6,122 @@
 #pragma once
 
 #include "ECS/ECS.h"
+#include "Util/AABB.h"
+#include "Util/SpatialGrid.h"
+#include "Util/SweepAndPrune.h"
+#include "Util/AABBTree.h"
+#include "Util/AABBBatch.h"
+#include "Event/ContactEvent.h"
+#include <cstdint>
 
+/**
+ * How BoxCollisionSystem narrows down which colliders could be touching.
+ * SpatialGrid suits colliders of similar size, no larger than a few cells.
+ * SweepAndPrune suits scenes mixing huge and tiny colliders that move a little each frame.
+ * AABBTree suits any mix of sizes, and reuses the tree BoxCollisionSystem keeps for queries anyway.
+ */
+enum class EBroadphase
+{
+    SpatialGrid = 0,
+    SweepAndPrune,
+    AABBTree,
+};
+
+/** Closest collider a ray hit, see BoxCollisionSystem::Raycast */
+struct RaycastHit
+{
+    Entity HitEntity;
+    glm::vec2 Point;
+    float Distance = 0.0f;
+};
+
+/**
+ * Finds overlapping box colliders. After every update it emits one ContactBeginEvent,
+ * ContactStayEvent and ContactEndEvent, each with every contact in that phase.
+ * A broadphase (see EBroadphase) first narrows the pairs down to colliders near each other,
+ * so most pairs are never tested at all.
+ *
+ * Every collider is also kept in an AABBTree whatever the broadphase, for spatial queries.
+ * Queries see colliders where they were as of the last Update.
+ */
 class BoxCollisionSystem : public System 
 {
 public:
-    BoxCollisionSystem();
+    BoxCollisionSystem(const EBroadphase InBroadphase = EBroadphase::SpatialGrid);
+
+    const EBroadphase GetBroadphase() const { return Broadphase; }
 
     void Update(const float DeltaTime) override;
 
+    /**
+     * Finds which colliders touch in the restored world, without emitting any events, so the next 
+     * Update only reports contacts that begin or end after the restored frame. Those are the contacts
+     * the restored frame's Update found as long as nothing moved colliders after it, so add this
+     * system after the ones that move things.
+     */
+    void OnWorldRestored() override;
+
+    /** Whether A and B's colliders were touching as of the last Update */
+    const bool IsTouching(const Entity A, const Entity B) const;
+
+    /** Every collider whose box overlaps Bounds (touching edges do not count) */
+    std::vector<Entity> QueryAABB(const AABB& Bounds) const;
+
+    /** Every collider whose box contains Point, edges included */
+    std::vector<Entity> QueryPoint(const glm::vec2 Point) const;
+
+    /**
+     * Finds the closest collider along the ray from Origin in Direction, up to MaxDistance away.
+     * A collider the ray starts inside is hit at distance 0. Returns false if nothing was hit.
+     */
+    const bool Raycast(const glm::vec2 Origin, const glm::vec2 Direction, const float MaxDistance, RaycastHit& OutHit) const;
+
 private:
-    const bool DetectCollision(const class BoxColliderComponent& ABox, 
-        const BoxColliderComponent& BBox,
-        const class TransformComponent& ATransform, 
-        const TransformComponent& BTransform);
+    /** Broadphase and narrowphase: fills NewContactKeys, sorted, with every touching pair */
+    void FindContacts();
+
+    /** Narrowphase: fills NewContactKeys with every candidate pair whose bounds really overlap */
+    void DetectCollisions();
+
+    /** Diffs NewContactKeys against ContactKeys and emits the contacts that began, stayed and ended */
+    void EmitContactEvents();
+
+    /** Moves every entity's proxy in Tree to its new bounds, adding and removing proxies as entities come and go */
+    void UpdateTree();
+
+    /** The entity in this system with the ID Proxy's user data holds, or nullptr if it has left */
+    const Entity* FindProxyEntity(const unsigned int Proxy) const;
+
+    const EBroadphase Broadphase;
+    SpatialGrid Grid{ CoreStatics::CollisionCellSize };
+    SweepAndPrune Sweep;
+    AABBTree Tree{ CoreStatics::CollisionTreeMargin };
+
+    /** Index indicates entity ID, the entity's proxy in Tree or AABBTree::NullNode */
+    std::vector<unsigned int> TreeProxies;
+
+    /** IDs of every entity that has a proxy in Tree */
+    std::vector<unsigned int> ProxyIDs;
+
+    /** Index indicates the entity's position in GetEntities(), rebuilt every update */
+    std::vector<AABB> Bounds;
+    std::vector<std::pair<unsigned int, unsigned int>> Candidates;
+
+    /** Candidates grouped by their first collider, see DetectCollisions */
+    std::vector<unsigned int> PartnerStarts;
+    std::vector<unsigned int> Partners;
+    AABBBatch PartnerBounds;
+    std::vector<unsigned int> Hits;
+
+    /**
+     * Every touching pair as of the last update, sorted. Each pair is keyed by both entities'
+     * handles, the lesser in the high 32 bits (see ContactKey), so it is stored exactly once.
+     */
+    std::vector<uint64_t> ContactKeys;
+    std::vector<uint64_t> NewContactKeys;
 
-    void HandleCollision(const Entity& A, const Entity& B);
-};
\ No newline at end of file
+    /** Batches handed to the contact events, kept to reuse their memory */
+    std::vector<Contact> BeganContacts;
+    std::vector<Contact> StayedContacts;
+    std::vector<Contact> EndedContacts;
+};
@@ -6,7 +6,7 @@
 #include "DamageSystem.h"
 #include "ECS/Components/BoxColliderComponent.h"
 #include "Game/Game.h"
-#include "Event/CollisionEvent.h"
+#include "Event/ContactEvent.h"
 #include "EventBus/EventBus.h"
 
 DamageSystem::DamageSystem()
@@ -15,7 +15,7 @@ DamageSystem::DamageSystem()
 
     if (auto* eventManager = Game::GetEventManager())
     {
-        eventManager->RegisterHandler<DamageSystem, CollisionEvent>(this, &DamageSystem::TestCallback);
+        eventManager->RegisterHandler<DamageSystem, ContactBeginEvent>(this, &DamageSystem::TestCallback);
     }
 }
 
@@ -23,11 +23,11 @@ void DamageSystem::Update(const float DeltaTime)
 {
     if (auto* eventManager = Game::GetEventManager())
     {
-        eventManager->UnRegisterHandler<DamageSystem, CollisionEvent>(this);
+        eventManager->UnRegisterHandler<DamageSystem, ContactBeginEvent>(this);
     }
 }
 
-void DamageSystem::TestCallback(CollisionEvent& Event)
+void DamageSystem::TestCallback(ContactBeginEvent& Event)
 {
     Logger::LogMessage("DamageSystem::TestCallback");
 }
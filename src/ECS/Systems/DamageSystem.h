@@ -13,5 +13,5 @@ public:
     DamageSystem();
 
     void Update(const float DeltaTime) override;
-    void TestCallback(class CollisionEvent& Event);
+    void TestCallback(class ContactBeginEvent& Event);
 };
\ No newline at end of file
@@ -0,0 +1,283 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "HierarchySystem.h"
+#include "ECS/Components/TransformComponent.h"
+#include "ECS/Components/HierarchyComponent.h"
+#include "ECS/Components/WorldTransformComponent.h"
+#include <cmath>
+
+HierarchySystem::HierarchySystem()
+{
+    RequireComponent<TransformComponent>();
+    RequireComponent<HierarchyComponent>();
+    RequireComponent<WorldTransformComponent>();
+
+    ReadsComponent<TransformComponent>();
+    WritesComponent<HierarchyComponent>();
+    WritesComponent<WorldTransformComponent>();
+}
+
+void HierarchySystem::Update(const float DeltaTime)
+{
+    ECSManager* owner = GetOwner();
+
+    for (const Entity& entity : owner->ViewChanged<TransformComponent>(TransformVersion))
+    {
+        if (HasEntity(entity))
+        {
+            MarkDirty(entity);
+        }
+    }
+
+    if (PendingDirty.empty())
+    {
+        return;
+    }
+
+    // The same entity can be dirtied more than once
+    std::sort(PendingDirty.begin(), PendingDirty.end());
+    PendingDirty.erase(std::unique(PendingDirty.begin(), PendingDirty.end()), PendingDirty.end());
+
+    // Only start from the topmost dirty entity of each subtree, everything under it is recomputed anyway
+    Queue.clear();
+
+    for (const Entity& entity : PendingDirty)
+    {
+        if (owner->IsAlive(entity) == false || HasEntity(entity) == false)
+        {
+            continue;
+        }
+
+        bool ancestorDirty = false;
+        Entity parent = owner->GetComponent<HierarchyComponent>(entity).Parent;
+
+        while (ancestorDirty == false && owner->IsAlive(parent) && HasEntity(parent))
+        {
+            ancestorDirty = IsDirty(parent);
+            parent = owner->GetComponent<HierarchyComponent>(parent).Parent;
+        }
+
+        if (ancestorDirty == false)
+        {
+            Queue.push_back(entity);
+        }
+    }
+
+    PendingDirty.clear();
+    ++DirtyRound;
+
+    // Breadth-first, so a parent's world transform is always done before its children read it
+    for (size_t head = 0; head < Queue.size(); ++head)
+    {
+        const Entity entity = Queue[head];
+
+        HierarchyComponent& hierarchy = owner->GetComponent<HierarchyComponent>(entity);
+        const TransformComponent& local = owner->GetComponent<TransformComponent>(entity);
+        WorldTransformComponent& world = owner->GetComponent<WorldTransformComponent>(entity);
+
+        if (owner->IsAlive(hierarchy.Parent) && HasEntity(hierarchy.Parent))
+        {
+            const WorldTransformComponent& parentWorld = owner->GetComponent<WorldTransformComponent>(hierarchy.Parent);
+
+            // Rotations are in degrees, same as SDL_RenderCopyEx
+            const double radians = parentWorld.Rotation * 3.14159265358979323846 / 180.0;
+            const float cosine = static_cast<float>(std::cos(radians));
+            const float sine = static_cast<float>(std::sin(radians));
+            const Vector2 offset = local.Position * parentWorld.Scale;
+
+            world.Position = parentWorld.Position + Vector2(
+                offset.x * cosine - offset.y * sine, 
+                offset.x * sine + offset.y * cosine
+            );
+            world.Scale = parentWorld.Scale * local.Scale;
+            world.Rotation = parentWorld.Rotation + local.Rotation;
+        }
+        else
+        {
+            // Roots (and orphans whose parent was destroyed) are just their local transform
+            hierarchy.Parent = Entity();
+            world.Position = local.Position;
+            world.Scale = local.Scale;
+            world.Rotation = local.Rotation;
+        }
+
+        owner->MarkChanged<WorldTransformComponent>(entity);
+
+        for (Entity child = hierarchy.FirstChild; owner->IsAlive(child); 
+            child = owner->GetComponent<HierarchyComponent>(child).NextSibling)
+        {
+            Queue.push_back(child);
+        }
+    }
+}
+
+void HierarchySystem::OnWorldRestored()
+{
+    ECSManager* owner = GetOwner();
+
+    // What was pending belongs to the world that was replaced. Starting from every root recomputes
+    // the same world transforms whether or not they were up to date in the restored world.
+    PendingDirty.clear();
+    ++DirtyRound;
+
+    for (const Entity& entity : GetEntities())
+    {
+        const Entity parent = owner->GetComponent<HierarchyComponent>(entity).Parent;
+
+        if (owner->IsAlive(parent) == false || HasEntity(parent) == false)
+        {
+            MarkDirty(entity);
+        }
+    }
+}
+
+void HierarchySystem::SetParent(const Entity Child, const Entity Parent)
+{
+    assert(Child != Parent);
+
+    ECSManager* owner = GetOwner();
+
+    AddToHierarchy(Parent);
+    AddToHierarchy(Child);
+    Detach(Child);
+
+    if (CoreStatics::IsDebugBuild)
+    {
+        // Parenting something under its own descendant would make a cycle
+        for (Entity ancestor = Parent; owner->IsAlive(ancestor); 
+            ancestor = owner->GetComponent<HierarchyComponent>(ancestor).Parent)
+        {
+            assert(ancestor != Child);
+        }
+    }
+
+    // Only grab references once every component is added, adding can move them
+    HierarchyComponent& parentHierarchy = owner->GetComponent<HierarchyComponent>(Parent);
+    HierarchyComponent& childHierarchy = owner->GetComponent<HierarchyComponent>(Child);
+
+    childHierarchy.Parent = Parent;
+    childHierarchy.NextSibling = parentHierarchy.FirstChild;
+    parentHierarchy.FirstChild = Child;
+}
+
+void HierarchySystem::Detach(const Entity Child)
+{
+    ECSManager* owner = GetOwner();
+
+    if (owner->IsAlive(Child) == false || owner->HasComponent<HierarchyComponent>(Child) == false)
+    {
+        return;
+    }
+
+    HierarchyComponent& childHierarchy = owner->GetComponent<HierarchyComponent>(Child);
+    const Entity parent = childHierarchy.Parent;
+
+    if (owner->IsAlive(parent) && owner->HasComponent<HierarchyComponent>(parent))
+    {
+        HierarchyComponent& parentHierarchy = owner->GetComponent<HierarchyComponent>(parent);
+
+        if (parentHierarchy.FirstChild == Child)
+        {
+            parentHierarchy.FirstChild = childHierarchy.NextSibling;
+        }
+        else
+        {
+            for (Entity sibling = parentHierarchy.FirstChild; owner->IsAlive(sibling);)
+            {
+                HierarchyComponent& siblingHierarchy = owner->GetComponent<HierarchyComponent>(sibling);
+
+                if (siblingHierarchy.NextSibling == Child)
+                {
+                    siblingHierarchy.NextSibling = childHierarchy.NextSibling;
+                    break;
+                }
+
+                sibling = siblingHierarchy.NextSibling;
+            }
+        }
+    }
+
+    childHierarchy.Parent = Entity();
+    childHierarchy.NextSibling = Entity();
+    MarkDirty(Child);
+}
+
+void HierarchySystem::DestroyEntity(const Entity InEntity)
+{
+    ECSManager* owner = GetOwner();
+
+    if (owner->IsAlive(InEntity) == false)
+    {
+        return;
+    }
+
+    if (owner->HasComponent<HierarchyComponent>(InEntity) == false)
+    {
+        owner->DestroyEntity(InEntity);
+        return;
+    }
+
+    Detach(InEntity);
+
+    // Collect the whole subtree before killing anything, dead entities' links can't be followed
+    std::vector<Entity> subtree = { InEntity };
+
+    for (size_t head = 0; head < subtree.size(); ++head)
+    {
+        for (Entity child = owner->GetComponent<HierarchyComponent>(subtree[head]).FirstChild; owner->IsAlive(child);
+            child = owner->GetComponent<HierarchyComponent>(child).NextSibling)
+        {
+            subtree.push_back(child);
+        }
+    }
+
+    for (const Entity& entity : subtree)
+    {
+        owner->DestroyEntity(entity);
+    }
+}
+
+void HierarchySystem::AddToHierarchy(const Entity InEntity)
+{
+    ECSManager* owner = GetOwner();
+
+    if (owner->HasComponent<TransformComponent>(InEntity) == false)
+    {
+        owner->AddComponent<TransformComponent>(InEntity);
+    }
+
+    if (owner->HasComponent<HierarchyComponent>(InEntity) == false)
+    {
+        owner->AddComponent<HierarchyComponent>(InEntity);
+        MarkDirty(InEntity);
+    }
+
+    if (owner->HasComponent<WorldTransformComponent>(InEntity) == false)
+    {
+        // Copy, adding a component can move the entity's existing ones
+        const TransformComponent local = owner->GetComponent<TransformComponent>(InEntity);
+        owner->AddComponent<WorldTransformComponent>(InEntity, local.Position, local.Scale, local.Rotation);
+    }
+}
+
+void HierarchySystem::MarkDirty(const Entity InEntity)
+{
+    const unsigned int id = InEntity.GetID();
+
+    if (id >= DirtyRounds.size())
+    {
+        DirtyRounds.resize(id + 1, 0);
+    }
+
+    DirtyRounds[id] = DirtyRound;
+    PendingDirty.push_back(InEntity);
+}
+
+const bool HierarchySystem::IsDirty(const Entity InEntity) const
+{
+    const unsigned int id = InEntity.GetID();
+    return id < DirtyRounds.size() && DirtyRounds[id] == DirtyRound;
+}
\ No newline at end of file
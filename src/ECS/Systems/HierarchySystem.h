@@ -0,0 +1,63 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "ECS/ECS.h"
+
+/**
+ * Computes WorldTransformComponent for every entity in a parent/child hierarchy.
+ * 
+ * Only subtrees under an entity whose TransformComponent changed (see ECSManager::ViewChanged)
+ * or that was re-parented are recomputed, breadth-first from the top of each subtree so every
+ * parent is up to date before its children. Add it after the systems that move things.
+ */
+class HierarchySystem : public System
+{
+public:
+    HierarchySystem();
+
+    void Update(const float DeltaTime) override;
+
+    /** Recomputes every world transform on the next Update, whatever was pending when the world was saved */
+    void OnWorldRestored() override;
+
+    /** Makes Child a child of Parent, detaching it from its old parent first. Adds the hierarchy components if needed. */
+    void SetParent(const Entity Child, const Entity Parent);
+
+    /** Makes Child a root again */
+    void Detach(const Entity Child);
+
+    /**
+     * Detaches InEntity and destroys it along with all of its descendants.
+     * Use this rather than Entity::Kill for anything in a hierarchy, or its parent's child list breaks.
+     */
+    void DestroyEntity(const Entity InEntity);
+
+private:
+    /** Adds HierarchyComponent and WorldTransformComponent to InEntity if it lacks them */
+    void AddToHierarchy(const Entity InEntity);
+
+    void MarkDirty(const Entity InEntity);
+
+    /** Whether InEntity is waiting in PendingDirty for this Update */
+    const bool IsDirty(const Entity InEntity) const;
+
+    /** Entities dirtied since the last Update that might not show up as changed transforms */
+    std::vector<Entity> PendingDirty;
+
+    /** Transform change version as of the last Update */
+    unsigned int TransformVersion = 0;
+
+    /**
+     * Index indicates entity ID, the round the entity was last dirtied in. Entities dirtied in
+     * the current round are exactly the ones in PendingDirty, whatever was loaded or restored.
+     */
+    std::vector<unsigned int> DirtyRounds;
+    unsigned int DirtyRound = 1;
+
+    /** Reused every Update: the breadth-first queue */
+    std::vector<Entity> Queue;
+};
\ No newline at end of file
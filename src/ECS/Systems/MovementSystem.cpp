@@ -11,18 +11,20 @@ MovementSystem::MovementSystem()
 {
     RequireComponent<TransformComponent>();
     RequireComponent<RigidBodyComponent>();
+
+    WritesComponent<TransformComponent>();
+    ReadsComponent<RigidBodyComponent>();
 }
 
 void MovementSystem::Update(const float DeltaTime)
 {
-    for (const Entity& entity : GetEntities())
-    {
-        auto& transform = entity.GetComponent<TransformComponent>();
-        const auto& rigidBody = entity.GetComponent<RigidBodyComponent>();
-
-        transform.Position.x += rigidBody.Velocity.x * DeltaTime;
-        transform.Position.y += rigidBody.Velocity.y * DeltaTime;
-    }
+    GetOwner()->View<TransformComponent, RigidBodyComponent>().ParallelEach(CoreStatics::ParallelChunkSize,
+        [DeltaTime](TransformComponent& Transform, const RigidBodyComponent& RigidBody)
+        {
+            Transform.Position.x += RigidBody.Velocity.x * DeltaTime;
+            Transform.Position.y += RigidBody.Velocity.y * DeltaTime;
+        }
+    );
 }
 
 void MovementSystem::AddVelocity(const float X, const float Y)
@@ -6,6 +6,7 @@
 #include "RenderSystem.h"
 #include "ECS/Components/SpriteComponent.h"
 #include "ECS/Components/TransformComponent.h"
+#include "ECS/Components/WorldTransformComponent.h"
 #include "ECS/Components/BoxColliderComponent.h"
 #include <SDL.h>
 #include "Game/Game.h"
@@ -15,32 +16,68 @@ RenderSystem::RenderSystem()
 {
     RequireComponent<SpriteComponent>();
     RequireComponent<TransformComponent>();
+
+    // Nothing happens during simulation ticks, so don't hold up the systems that do work there
+    ReadsComponent<SpriteComponent>();
+    ReadsComponent<TransformComponent>();
+    ReadsComponent<WorldTransformComponent>();
 }
 
 void RenderSystem::Update(const float DeltaTime)
+{
+
+}
+
+void RenderSystem::Render(const float Alpha)
 {
     SDL_Renderer* renderer = Game::GetRenderer();
     AssetStore* assetManager = Game::GetAssetManager();
 
     if (renderer != nullptr && assetManager != nullptr)
     {
+        // Draw back to front. Sorting here rather than on insert means ZOrder changes are picked up too
+        SortEntities([](const Entity& A, const Entity& B)
+        {
+            return A.GetComponent<SpriteComponent>().ZOrder < B.GetComponent<SpriteComponent>().ZOrder;
+        });
+
         SDL_RenderClear(renderer);
 
         for (const Entity& entity : GetEntities())
         {
-            const auto& transform = entity.GetComponent<TransformComponent>();
             const auto& sprite = entity.GetComponent<SpriteComponent>();
 
+            Vector2 position;
+            Vector2 scale;
+            double rotation;
+
+            // Blend between the last two simulation ticks so motion stays smooth at any frame rate.
+            // Entities in a hierarchy draw where their parents put them.
+            if (entity.HasComponent<WorldTransformComponent>())
+            {
+                const auto& world = entity.GetComponent<WorldTransformComponent>();
+                position = world.PreviousPosition + (world.Position - world.PreviousPosition) * Alpha;
+                rotation = world.PreviousRotation + (world.Rotation - world.PreviousRotation) * Alpha;
+                scale = world.Scale;
+            }
+            else
+            {
+                const auto& transform = entity.GetComponent<TransformComponent>();
+                position = transform.PreviousPosition + (transform.Position - transform.PreviousPosition) * Alpha;
+                rotation = transform.PreviousRotation + (transform.Rotation - transform.PreviousRotation) * Alpha;
+                scale = transform.Scale;
+            }
+
             SDL_Texture* texture = assetManager->GetTexture(sprite.AssetID);
             SDL_Rect sourceRect = sprite.SourceRect;
             SDL_Rect destRect = {
-                static_cast<int>(transform.Position.x),					// Origin X
-                static_cast<int>(transform.Position.y),					// Origin Y
-                static_cast<int>(sprite.Width * transform.Scale.x),		// Width
-                static_cast<int>(sprite.Height * transform.Scale.x)		// Height
+                static_cast<int>(position.x),							// Origin X
+                static_cast<int>(position.y),							// Origin Y
+                static_cast<int>(sprite.Width * scale.x),				// Width
+                static_cast<int>(sprite.Height * scale.x)				// Height
             };
 
-            SDL_RenderCopyEx(renderer, texture, &sourceRect, &destRect, transform.Rotation, nullptr, SDL_FLIP_NONE);
+            SDL_RenderCopyEx(renderer, texture, &sourceRect, &destRect, rotation, nullptr, SDL_FLIP_NONE);
 
             // Render debug collider shapes
             if (CoreStatics::IsDebugBuild && 
@@ -49,8 +86,8 @@ void RenderSystem::Update(const float DeltaTime)
             {
                 const auto& boxCollider = entity.GetComponent<BoxColliderComponent>();
                 SDL_Rect colliderRect = {
-                    static_cast<int>(transform.Position.x + boxCollider.Offset.x),
-                    static_cast<int>(transform.Position.y + boxCollider.Offset.y),
+                    static_cast<int>(position.x + boxCollider.Offset.x),
+                    static_cast<int>(position.y + boxCollider.Offset.y),
                     static_cast<int>(boxCollider.Width),
                     static_cast<int>(boxCollider.Height)
                 };
@@ -68,34 +105,3 @@ void RenderSystem::Update(const float DeltaTime)
     }
 
 }
-
-void RenderSystem::AddEntity(const Entity InEntity)
-{
-    const auto zOrder = InEntity.GetComponent<SpriteComponent>().ZOrder;
-
-    if (EntityIDs.count(InEntity.GetID()) == 0)
-    {
-        EntityIDs.insert(InEntity.GetID());
-
-        if (Entities.size() > 0)
-        {
-            auto it = Entities.begin();
-
-            while (it != Entities.end())
-            {
-                if (it->GetComponent<SpriteComponent>().ZOrder >= zOrder)
-                {
-                    // Found the first zOrder greater or equal, insert immediately before it
-                    break;
-                }
-                ++it;
-            }
-
-            Entities.insert(it, InEntity);
-        }
-        else
-        {
-            Entities.push_back(InEntity);
-        }
-    }
-}
@@ -13,5 +13,5 @@ public:
     RenderSystem();
 
     void Update(const float DeltaTime) override;
-    void AddEntity(const Entity InEntity) override;
+    void Render(const float Alpha) override;
 };
\ No newline at end of file
@@ -0,0 +1,50 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "Event.h"
+#include "ECS/ECS.h"
+
+/** Two colliders touching, the lesser entity (see Entity::operator<) first */
+struct Contact
+{
+    Entity A;
+    Entity B;
+};
+
+/**
+ * Every contact that reached one phase in a single BoxCollisionSystem update, emitted as one
+ * batch per phase. Contacts is only valid for the duration of the handler.
+ */
+class ContactEvent : public Event
+{
+public:
+    ContactEvent(const std::vector<Contact>& Contacts)
+        : Contacts(Contacts) {}
+
+    const std::vector<Contact>& Contacts;
+};
+
+/** Colliders that started touching this update */
+class ContactBeginEvent : public ContactEvent
+{
+public:
+    using ContactEvent::ContactEvent;
+};
+
+/** Colliders that were already touching and still are */
+class ContactStayEvent : public ContactEvent
+{
+public:
+    using ContactEvent::ContactEvent;
+};
+
+/** Colliders that stopped touching, or left the system, this update. Either entity may no longer be alive. */
+class ContactEndEvent : public ContactEvent
+{
+public:
+    using ContactEvent::ContactEvent;
+};
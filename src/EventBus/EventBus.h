@@ -20,13 +20,15 @@
 class IEventCallback
 {
 public:
-    void Execute(Event EventToExecute)
+    virtual ~IEventCallback() = default;
+
+    void Execute(Event& EventToExecute)
     {
         Call(EventToExecute);
     }
 
 protected:
-    virtual void Call(Event EventToCall) = 0;
+    virtual void Call(Event& EventToCall) = 0;
 };
 
 // Template extension of IEventCallback
@@ -51,7 +53,7 @@ private:
     THandler* Handler;
 
 protected:
-    void Call(Event EventToCall) override
+    void Call(Event& EventToCall) override
     {
         std::invoke(Callback, Handler, static_cast<TEvent&>(EventToCall));
     }
@@ -115,9 +117,12 @@ public:
 
         if (HandlerMap.count(typeID))
         {
+            // Passed by reference, so handlers see the whole TEvent rather than a sliced Event
+            TEvent event(std::forward<TArgs>(Args)...);
+
             for (IEventCallback* callback : HandlerMap[typeID])
             {
-                callback->Execute(TEvent(std::forward<TArgs>(Args)...));
+                callback->Execute(event);
             }
         }
     }
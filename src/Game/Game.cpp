@@ -9,10 +9,12 @@
 #include "Game.h"
 #include "Asset/AssetStore.h"
 #include "Util/CoreStatics.h"
+#include "Util/AABBBatch.h"
 #include "EventBus/EventBus.h"
 #include "ECS/Systems/RenderSystem.h" // includes ECS.h
 #include "glm/glm.hpp"
 #include "ECS/Components/TransformComponent.h"
+#include "ECS/Components/WorldTransformComponent.h"
 #include "ECS/Components/SpriteComponent.h"
 
 ECSManager* Game::GameManager = nullptr;
@@ -65,6 +67,25 @@ void Game::ProcessInput()
                 {
                     CoreStatics::DrawDebugColliders = !CoreStatics::DrawDebugColliders;
                 }
+                // Debug use F2 to benchmark the collision overlap kernel against plain scalar tests
+                else if (sdlEvent.key.keysym.sym == SDLK_F2)
+                {
+                    const AABBBatchBenchmark result = AABBBatch::Benchmark(4096, 16);
+
+                    Logger::LogMessage("Overlap kernel (" + std::to_string(AABBBatch::LaneWidth) + " wide): scalar " +
+                        std::to_string(result.ScalarSeconds * 1000.0) + "ms, SIMD " + 
+                        std::to_string(result.SimdSeconds * 1000.0) + "ms, " +
+                        std::to_string(result.NumOverlaps) + " overlaps" + (result.Matched ? "" : ", RESULTS DIFFER"));
+                }
+                // Debug use F3 to benchmark saving and restoring rollback frames
+                else if (sdlEvent.key.keysym.sym == SDLK_F3)
+                {
+                    const RollbackBenchmark result = ECSManager::BenchmarkRollback(10000, 100);
+
+                    Logger::LogMessage("Rollback (10000 entities, 100 frames): save " +
+                        std::to_string(result.SaveSeconds * 10000.0) + "us, restore " +
+                        std::to_string(result.RestoreSeconds * 10000.0) + "us per frame" + (result.Matched ? "" : ", RESTORE DIFFERS"));
+                }
             }
             break;
         }
@@ -73,12 +94,28 @@ void Game::ProcessInput()
 
 void Game::Update(const float DeltaTime)
 {
+    // Remember where everything was before this tick moves it, for render interpolation.
+    // Only transforms written since the last tick can differ from their previous state.
+    for (const Entity& entity : GameManager->ViewChanged<TransformComponent>(TransformSnapshotVersion))
+    {
+        TransformComponent& transform = GameManager->GetComponent<TransformComponent>(entity);
+        transform.PreviousPosition = transform.Position;
+        transform.PreviousRotation = transform.Rotation;
+    }
+
+    for (const Entity& entity : GameManager->ViewChanged<WorldTransformComponent>(WorldTransformSnapshotVersion))
+    {
+        WorldTransformComponent& world = GameManager->GetComponent<WorldTransformComponent>(entity);
+        world.PreviousPosition = world.Position;
+        world.PreviousRotation = world.Rotation;
+    }
+
     GameManager->Update(DeltaTime);
 }
 
-void Game::Render(const float DeltaTime)
+void Game::Render(const float Alpha)
 {
-
+    GameManager->Render(Alpha);
 }
 
 void Game::LoadLevel(const std::string& TilemapTextureID, const std::string& MapFilePath)
@@ -138,6 +175,24 @@ void Game::LoadLevel(const std::string& TilemapTextureID, const std::string& Map
         static_cast<double>(mapNumRows * tileSize)
     );
 
+    // Count the tiles up front so they can all be created in one batch
+    int numTiles = 0;
+    for (const std::vector<std::string>& col : tileValues)
+    {
+        for (const std::string& row : col)
+        {
+            numTiles += (row.length() == 2) ? 1 : 0;
+        }
+    }
+
+    // Every tile starts from the same prototype, then gets its own position and source rect
+    const std::vector<Entity> tiles = GameManager->CreateEntities(
+        numTiles,
+        TransformComponent(Vector2(0, 0), Vector2(tileScale, tileScale)),
+        SpriteComponent("Tilemap", tileSize, tileSize, 0, 0, -1)
+    );
+
+    int tileIdx = 0;
     int y = 0;
     for (const std::vector<std::string>& col : tileValues)
     {
@@ -150,23 +205,18 @@ void Game::LoadLevel(const std::string& TilemapTextureID, const std::string& Map
                 int currentSrcRectY = (row[0] - '0') * tileSize;
                 int currentSrcRectX = (row[1] - '0') * tileSize;
 
-                Entity tile = GameManager->CreateEntity();
+                const Entity& tile = tiles[tileIdx++];
 
-                tile.AddComponent<TransformComponent>(
-                    Vector2(
-                        x++ * tileScale * tileSize, 
-                        y * tileScale * tileSize
-                    ),
-                    Vector2(tileScale, tileScale)
+                TransformComponent& transform = tile.GetComponent<TransformComponent>();
+                transform.Position = Vector2(
+                    x++ * tileScale * tileSize, 
+                    y * tileScale * tileSize
                 );
+                transform.PreviousPosition = transform.Position;
 
-                tile.AddComponent<SpriteComponent>(
-                    "Tilemap",
-                    tileSize, tileSize,
-                    currentSrcRectX,
-                    currentSrcRectY,
-                    -1
-                );
+                SDL_Rect& sourceRect = tile.GetComponent<SpriteComponent>().SourceRect;
+                sourceRect.x = currentSrcRectX;
+                sourceRect.y = currentSrcRectY;
             }
         }
         ++y;
@@ -234,22 +284,34 @@ void Game::Run()
 {
     Setup();
 
+    PreviousFrameCounter = SDL_GetPerformanceCounter();
+
     while (IsRunning)
     {
         ProcessInput();
 
-        // Get delta time in milliseconds
-        const unsigned MillisecsCurrentFrame = SDL_GetTicks();		
+        // Get real frame time in seconds (conceptually, things should happen "per second")
+        const Uint64 currentFrameCounter = SDL_GetPerformanceCounter();
+        TickAccumulator += static_cast<double>(currentFrameCounter - PreviousFrameCounter) / SDL_GetPerformanceFrequency();
+        PreviousFrameCounter = currentFrameCounter;
 
-        // Convert to seconds for ease of use (conceptually, things should happen "per second")
-        const float deltaTime = (MillisecsCurrentFrame - MillisecsPreviousFrame) * CoreStatics::OneMillisec;
+        // Simulate in fixed steps so a frame hitch can never turn into one huge integration step
+        unsigned int numTicks = 0;
 
-        Update(deltaTime);
-        
-        // Cache current milliseconds per frame to calculate next delta time
-        MillisecsPreviousFrame = MillisecsCurrentFrame;
+        while (TickAccumulator >= CoreStatics::FixedTimeStep && numTicks < CoreStatics::MaxTicksPerFrame)
+        {
+            Update(CoreStatics::FixedTimeStep);
+            TickAccumulator -= CoreStatics::FixedTimeStep;
+            ++numTicks;
+        }
+
+        // Too far behind to catch up, drop the backlog instead of falling further behind every frame
+        if (numTicks == CoreStatics::MaxTicksPerFrame && TickAccumulator >= CoreStatics::FixedTimeStep)
+        {
+            TickAccumulator = 0.0;
+        }
 
-        Render(deltaTime);
+        Render(static_cast<float>(TickAccumulator / CoreStatics::FixedTimeStep));
     }
 }
 
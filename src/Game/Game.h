@@ -7,6 +7,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <cstdint>
 
 struct SDL_Window;
 struct SDL_Renderer;
@@ -60,11 +61,17 @@ protected:
     /** Generic input routine. Game-specific logic can be extended in game classes. */
     virtual void ProcessInput();
 
-    /** Generic update loop. Game-specific logic can be extended in game classes. */
+    /** 
+     * Generic update loop, run once per fixed simulation tick (DeltaTime is always
+     * CoreStatics::FixedTimeStep). Game-specific logic can be extended in game classes. 
+     */
     virtual void Update(const float DeltaTime);
 
-    /** Generic render loop. Game-specific logic can be extended in game classes. */
-    virtual void Render(const float DeltaTime);
+    /** 
+     * Generic render loop, run once per frame after that frame's ticks. Alpha (0-1) is how far the 
+     * frame is between the last two ticks. Game-specific logic can be extended in game classes. 
+     */
+    virtual void Render(const float Alpha);
 
     /** Load a new level using string ID TilemapTextureID and a map file at MapFilePath */
     void LoadLevel(const std::string& TilemapTextureID, const std::string& MapFilePath);
@@ -85,5 +92,12 @@ private:
 private:
     bool IsRunning = false;
     SDL_Window* SDLWindow = nullptr;
-    unsigned int MillisecsPreviousFrame = 0;
+    uint64_t PreviousFrameCounter = 0;
+
+    /** Real time (in seconds) not yet consumed by simulation ticks */
+    double TickAccumulator = 0.0;
+
+    /** Change versions of the last transform snapshots taken for render interpolation */
+    unsigned int TransformSnapshotVersion = 0;
+    unsigned int WorldTransformSnapshotVersion = 0;
 };
\ No newline at end of file
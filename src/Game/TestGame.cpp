@@ -5,6 +5,7 @@
 
 #include "TestGame.h"
 #include "ECS/Systems/MovementSystem.h"
+#include "ECS/Systems/HierarchySystem.h"
 #include "ECS/Systems/AnimationSystem.h"
 #include "ECS/Systems/RenderSystem.h"
 #include "ECS/Systems/BoxCollisionSystem.h"
@@ -27,6 +28,7 @@ void TestGame::Setup()
     Game::Setup();
 
     GameManager->AddSystem<MovementSystem>();
+    GameManager->AddSystem<HierarchySystem>();
     GameManager->AddSystem<RenderSystem>();
     GameManager->AddSystem<AnimationSystem>();
     GameManager->AddSystem<BoxCollisionSystem>();
@@ -0,0 +1,100 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cmath>
+#include <algorithm>
+
+/**
+ * Axis-aligned bounding box in world space. Min is the top left corner, Max the bottom right.
+ */
+struct AABB
+{
+    glm::vec2 Min{ 0.0f, 0.0f };
+    glm::vec2 Max{ 0.0f, 0.0f };
+
+    /** Boxes that only touch along an edge do not overlap */
+    const bool Overlaps(const AABB& Other) const
+    {
+        return Min.x < Other.Max.x && Other.Min.x < Max.x && 
+            Min.y < Other.Max.y && Other.Min.y < Max.y;
+    }
+
+    const bool Contains(const AABB& Other) const
+    {
+        return Min.x <= Other.Min.x && Min.y <= Other.Min.y && 
+            Other.Max.x <= Max.x && Other.Max.y <= Max.y;
+    }
+
+    /** Points on the edge are inside */
+    const bool Contains(const glm::vec2 Point) const
+    {
+        return Min.x <= Point.x && Point.x <= Max.x && 
+            Min.y <= Point.y && Point.y <= Max.y;
+    }
+
+    /** Smallest box around both */
+    AABB Union(const AABB& Other) const
+    {
+        return { glm::min(Min, Other.Min), glm::max(Max, Other.Max) };
+    }
+
+    /** Grown by Margin on every side */
+    AABB Expanded(const float Margin) const
+    {
+        return { Min - glm::vec2(Margin, Margin), Max + glm::vec2(Margin, Margin) };
+    }
+
+    const float Perimeter() const
+    {
+        return 2.0f * ((Max.x - Min.x) + (Max.y - Min.y));
+    }
+
+    /**
+     * Clips the segment Origin + Delta * t, t in [0, InOutFraction], against the box.
+     * On a hit returns true and sets InOutFraction to where the segment enters (0 if it starts inside).
+     */
+    const bool Raycast(const glm::vec2 Origin, const glm::vec2 Delta, float& InOutFraction) const
+    {
+        float enter = 0.0f;
+        float exit = InOutFraction;
+
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            if (std::abs(Delta[axis]) < 1e-8f)
+            {
+                // Parallel to this slab, so it has to start within it
+                if (Origin[axis] < Min[axis] || Max[axis] < Origin[axis])
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            const float inverse = 1.0f / Delta[axis];
+            float slabEnter = (Min[axis] - Origin[axis]) * inverse;
+            float slabExit = (Max[axis] - Origin[axis]) * inverse;
+
+            if (slabEnter > slabExit)
+            {
+                std::swap(slabEnter, slabExit);
+            }
+
+            enter = std::max(enter, slabEnter);
+            exit = std::min(exit, slabExit);
+
+            if (enter > exit)
+            {
+                return false;
+            }
+        }
+
+        InOutFraction = enter;
+        return true;
+    }
+};
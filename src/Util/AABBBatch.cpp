@@ -0,0 +1,207 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "AABBBatch.h"
+#include <new>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace
+{
+    unsigned int CountTrailingZeros(const unsigned int Bits)
+    {
+#if defined(_MSC_VER)
+        unsigned long idx = 0;
+        _BitScanForward(&idx, Bits);
+        return static_cast<unsigned int>(idx);
+#else
+        return static_cast<unsigned int>(__builtin_ctz(Bits));
+#endif
+    }
+
+    /** Writes Base + the position of every set bit in Mask to OutIndices, returns how many */
+    size_t WriteHits(unsigned int Mask, const unsigned int Base, unsigned int* OutIndices)
+    {
+        size_t numHits = 0;
+
+        while (Mask != 0)
+        {
+            OutIndices[numHits++] = Base + CountTrailingZeros(Mask);
+            Mask &= Mask - 1;
+        }
+
+        return numHits;
+    }
+}
+
+AABBBatch::~AABBBatch()
+{
+    if (Memory != nullptr)
+    {
+        ::operator delete(Memory, std::align_val_t(Alignment));
+    }
+}
+
+void AABBBatch::Reserve(const size_t NewCapacity)
+{
+    if (NewCapacity <= Capacity)
+    {
+        return;
+    }
+
+    // Whole cache lines per array keeps every array aligned
+    const size_t capacity = (NewCapacity + 15) & ~static_cast<size_t>(15);
+    float* memory = static_cast<float*>(::operator new(capacity * 4 * sizeof(float), std::align_val_t(Alignment)));
+
+    if (Memory != nullptr)
+    {
+        std::memcpy(memory, MinX, Count * sizeof(float));
+        std::memcpy(memory + capacity, MinY, Count * sizeof(float));
+        std::memcpy(memory + capacity * 2, MaxX, Count * sizeof(float));
+        std::memcpy(memory + capacity * 3, MaxY, Count * sizeof(float));
+        ::operator delete(Memory, std::align_val_t(Alignment));
+    }
+
+    Memory = memory;
+    MinX = memory;
+    MinY = memory + capacity;
+    MaxX = memory + capacity * 2;
+    MaxY = memory + capacity * 3;
+    Capacity = capacity;
+}
+
+size_t AABBBatch::FindOverlaps(const AABB& Box, unsigned int* OutIndices) const
+{
+    size_t numHits = 0;
+    size_t idx = 0;
+
+#if defined(AABB_SIMD_AVX2)
+    const __m256 boxMinX = _mm256_set1_ps(Box.Min.x);
+    const __m256 boxMinY = _mm256_set1_ps(Box.Min.y);
+    const __m256 boxMaxX = _mm256_set1_ps(Box.Max.x);
+    const __m256 boxMaxY = _mm256_set1_ps(Box.Max.y);
+
+    for (; idx + 8 <= Count; idx += 8)
+    {
+        const __m256 overlapX = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_load_ps(MinX + idx), boxMaxX, _CMP_LT_OQ),
+            _mm256_cmp_ps(boxMinX, _mm256_load_ps(MaxX + idx), _CMP_LT_OQ));
+        const __m256 overlapY = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_load_ps(MinY + idx), boxMaxY, _CMP_LT_OQ),
+            _mm256_cmp_ps(boxMinY, _mm256_load_ps(MaxY + idx), _CMP_LT_OQ));
+
+        const int mask = _mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY));
+        numHits += WriteHits(static_cast<unsigned int>(mask), static_cast<unsigned int>(idx), OutIndices + numHits);
+    }
+#elif defined(AABB_SIMD_SSE2)
+    const __m128 boxMinX = _mm_set1_ps(Box.Min.x);
+    const __m128 boxMinY = _mm_set1_ps(Box.Min.y);
+    const __m128 boxMaxX = _mm_set1_ps(Box.Max.x);
+    const __m128 boxMaxY = _mm_set1_ps(Box.Max.y);
+
+    for (; idx + 4 <= Count; idx += 4)
+    {
+        const __m128 overlapX = _mm_and_ps(
+            _mm_cmplt_ps(_mm_load_ps(MinX + idx), boxMaxX),
+            _mm_cmplt_ps(boxMinX, _mm_load_ps(MaxX + idx)));
+        const __m128 overlapY = _mm_and_ps(
+            _mm_cmplt_ps(_mm_load_ps(MinY + idx), boxMaxY),
+            _mm_cmplt_ps(boxMinY, _mm_load_ps(MaxY + idx)));
+
+        const int mask = _mm_movemask_ps(_mm_and_ps(overlapX, overlapY));
+        numHits += WriteHits(static_cast<unsigned int>(mask), static_cast<unsigned int>(idx), OutIndices + numHits);
+    }
+#endif
+
+    // Whatever doesn't fill a whole lane
+    return numHits + FindOverlapsFrom(Box, idx, OutIndices + numHits);
+}
+
+size_t AABBBatch::FindOverlapsFrom(const AABB& Box, const size_t First, unsigned int* OutIndices) const
+{
+    size_t numHits = 0;
+
+    for (size_t idx = First; idx < Count; ++idx)
+    {
+        if (MinX[idx] < Box.Max.x && Box.Min.x < MaxX[idx] && MinY[idx] < Box.Max.y && Box.Min.y < MaxY[idx])
+        {
+            OutIndices[numHits++] = static_cast<unsigned int>(idx);
+        }
+    }
+
+    return numHits;
+}
+
+AABBBatchBenchmark AABBBatch::Benchmark(const size_t NumBoxes, const unsigned int Iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // A fixed seed, so runs are comparable
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> position(0.0f, 1024.0f);
+    std::uniform_real_distribution<float> size(4.0f, 64.0f);
+
+    AABBBatch batch;
+    batch.Reserve(NumBoxes);
+
+    for (size_t idx = 0; idx < NumBoxes; ++idx)
+    {
+        const glm::vec2 min(position(random), position(random));
+        batch.Push({ min, min + glm::vec2(size(random), size(random)) });
+    }
+
+    std::vector<unsigned int> scalarHits(NumBoxes);
+    std::vector<unsigned int> simdHits(NumBoxes);
+    AABBBatchBenchmark result;
+
+    // Check both paths agree before timing them
+    for (size_t idx = 0; idx < NumBoxes; ++idx)
+    {
+        const AABB box = batch.Get(idx);
+        const size_t numScalar = batch.FindOverlapsScalar(box, scalarHits.data());
+        const size_t numSimd = batch.FindOverlaps(box, simdHits.data());
+
+        result.NumOverlaps += numSimd;
+        result.Matched = result.Matched && numScalar == numSimd &&
+            std::equal(scalarHits.begin(), scalarHits.begin() + numScalar, simdHits.begin());
+    }
+
+    // The hit counts are summed so the calls can't be optimized away
+    size_t numTimedHits = 0;
+    const auto scalarStart = Clock::now();
+
+    for (unsigned int iteration = 0; iteration < Iterations; ++iteration)
+    {
+        for (size_t idx = 0; idx < NumBoxes; ++idx)
+        {
+            numTimedHits += batch.FindOverlapsScalar(batch.Get(idx), scalarHits.data());
+        }
+    }
+
+    const auto simdStart = Clock::now();
+
+    for (unsigned int iteration = 0; iteration < Iterations; ++iteration)
+    {
+        for (size_t idx = 0; idx < NumBoxes; ++idx)
+        {
+            numTimedHits -= batch.FindOverlaps(batch.Get(idx), simdHits.data());
+        }
+    }
+
+    const auto simdEnd = Clock::now();
+
+    result.ScalarSeconds = std::chrono::duration<double>(simdStart - scalarStart).count();
+    result.SimdSeconds = std::chrono::duration<double>(simdEnd - simdStart).count();
+    result.Matched = result.Matched && numTimedHits == 0;
+
+    return result;
+}
@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "AABB.h"
+#include <cstddef>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define AABB_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define AABB_SIMD_SSE2 1
+#endif
+
+/** Timings from AABBBatch::Benchmark, in seconds for the whole run */
+struct AABBBatchBenchmark
+{
+    double ScalarSeconds = 0.0;
+    double SimdSeconds = 0.0;
+    size_t NumOverlaps = 0;
+
+    /** Both paths found exactly the same overlaps */
+    bool Matched = true;
+};
+
+/**
+ * Many boxes stored as structure-of-arrays: one aligned float array each for min X, min Y,
+ * max X and max Y. Testing a box against the batch compares it with 8 boxes at a time
+ * using AVX2 (4 with SSE2), so a box in a dense cluster is checked against every neighbour
+ * in a handful of instructions.
+ */
+class AABBBatch
+{
+public:
+    /** Boxes tested per instruction */
+#if defined(AABB_SIMD_AVX2)
+    static constexpr unsigned int LaneWidth = 8;
+#elif defined(AABB_SIMD_SSE2)
+    static constexpr unsigned int LaneWidth = 4;
+#else
+    static constexpr unsigned int LaneWidth = 1;
+#endif
+
+    static constexpr size_t Alignment = 32;
+
+    AABBBatch() = default;
+    ~AABBBatch();
+
+    AABBBatch(const AABBBatch&) = delete;
+    AABBBatch& operator=(const AABBBatch&) = delete;
+
+    const size_t Size() const { return Count; }
+    void Clear() { Count = 0; }
+    void Reserve(const size_t NewCapacity);
+
+    void Push(const AABB& Box)
+    {
+        if (Count == Capacity)
+        {
+            Reserve((Capacity == 0) ? 64 : Capacity * 2);
+        }
+
+        MinX[Count] = Box.Min.x;
+        MinY[Count] = Box.Min.y;
+        MaxX[Count] = Box.Max.x;
+        MaxY[Count] = Box.Max.y;
+        ++Count;
+    }
+
+    AABB Get(const size_t Idx) const { return { { MinX[Idx], MinY[Idx] }, { MaxX[Idx], MaxY[Idx] } }; }
+
+    /**
+     * Writes the index of every box in the batch that overlaps Box (see AABB::Overlaps) to
+     * OutIndices, in order, and returns how many there were. OutIndices needs room for Size().
+     */
+    size_t FindOverlaps(const AABB& Box, unsigned int* OutIndices) const;
+
+    /** FindOverlaps one box at a time, for comparison */
+    size_t FindOverlapsScalar(const AABB& Box, unsigned int* OutIndices) const { return FindOverlapsFrom(Box, 0, OutIndices); }
+
+    /**
+     * Tests each of NumBoxes random boxes against all the others with both FindOverlaps and
+     * FindOverlapsScalar, Iterations times over.
+     */
+    static AABBBatchBenchmark Benchmark(const size_t NumBoxes, const unsigned int Iterations);
+
+private:
+    size_t FindOverlapsFrom(const AABB& Box, const size_t First, unsigned int* OutIndices) const;
+
+    /** One allocation holding all four arrays, Capacity floats each */
+    float* Memory = nullptr;
+    float* MinX = nullptr;
+    float* MinY = nullptr;
+    float* MaxX = nullptr;
+    float* MaxY = nullptr;
+
+    size_t Count = 0;
+    size_t Capacity = 0;
+};
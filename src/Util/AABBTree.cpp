@@ -0,0 +1,259 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "AABBTree.h"
+#include <algorithm>
+
+AABBTree::AABBTree(const float InMargin)
+    : Margin(InMargin)
+{
+}
+
+unsigned int AABBTree::AllocateNode()
+{
+    unsigned int nodeIdx;
+
+    if (FreeList == NullNode)
+    {
+        nodeIdx = static_cast<unsigned int>(Nodes.size());
+        Nodes.emplace_back();
+    }
+    else
+    {
+        nodeIdx = FreeList;
+        FreeList = Nodes[nodeIdx].Parent;
+        Nodes[nodeIdx] = Node();
+    }
+
+    Nodes[nodeIdx].Height = 0;
+    return nodeIdx;
+}
+
+void AABBTree::FreeNode(const unsigned int NodeIdx)
+{
+    Nodes[NodeIdx].Parent = FreeList;
+    Nodes[NodeIdx].Height = -1;
+    FreeList = NodeIdx;
+}
+
+unsigned int AABBTree::CreateProxy(const AABB& Bounds, const unsigned int UserData)
+{
+    const unsigned int proxy = AllocateNode();
+    Node& leaf = Nodes[proxy];
+    leaf.Bounds = Bounds;
+    leaf.FatBounds = Bounds.Expanded(Margin);
+    leaf.UserData = UserData;
+
+    InsertLeaf(proxy);
+    ++NumLeaves;
+
+    return proxy;
+}
+
+void AABBTree::DestroyProxy(const unsigned int Proxy)
+{
+    assert(Nodes[Proxy].IsLeaf() && Nodes[Proxy].Height == 0);
+
+    RemoveLeaf(Proxy);
+    FreeNode(Proxy);
+    --NumLeaves;
+}
+
+const bool AABBTree::MoveProxy(const unsigned int Proxy, const AABB& Bounds)
+{
+    Node& leaf = Nodes[Proxy];
+    leaf.Bounds = Bounds;
+
+    if (leaf.FatBounds.Contains(Bounds))
+    {
+        return false;
+    }
+
+    leaf.FatBounds = Bounds.Expanded(Margin);
+
+    RemoveLeaf(Proxy);
+    InsertLeaf(Proxy);
+
+    return true;
+}
+
+void AABBTree::InsertLeaf(const unsigned int Leaf)
+{
+    if (Root == NullNode)
+    {
+        Root = Leaf;
+        Nodes[Root].Parent = NullNode;
+        return;
+    }
+
+    // Walk down to the sibling that grows the tree's total perimeter least
+    const AABB leafBounds = Nodes[Leaf].FatBounds;
+    unsigned int sibling = Root;
+
+    while (Nodes[sibling].IsLeaf() == false)
+    {
+        const Node& node = Nodes[sibling];
+
+        const float perimeter = node.FatBounds.Perimeter();
+        const float combinedPerimeter = node.FatBounds.Union(leafBounds).Perimeter();
+
+        // Cost of pairing the leaf with this node, and the growth every descendant would inherit
+        const float cost = 2.0f * combinedPerimeter;
+        const float inheritedCost = 2.0f * (combinedPerimeter - perimeter);
+
+        const auto descendCost = [&](const unsigned int ChildIdx)
+        {
+            const Node& child = Nodes[ChildIdx];
+            const float grown = child.FatBounds.Union(leafBounds).Perimeter();
+            return (child.IsLeaf() ? grown : grown - child.FatBounds.Perimeter()) + inheritedCost;
+        };
+
+        const float cost1 = descendCost(node.Child1);
+        const float cost2 = descendCost(node.Child2);
+
+        if (cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+
+        sibling = (cost1 < cost2) ? node.Child1 : node.Child2;
+    }
+
+    // Nodes may reallocate here, so nothing holds a reference across it
+    const unsigned int oldParent = Nodes[sibling].Parent;
+    const unsigned int newParent = AllocateNode();
+
+    Nodes[newParent].Parent = oldParent;
+    Nodes[newParent].FatBounds = leafBounds.Union(Nodes[sibling].FatBounds);
+    Nodes[newParent].Height = Nodes[sibling].Height + 1;
+    Nodes[newParent].Child1 = sibling;
+    Nodes[newParent].Child2 = Leaf;
+    Nodes[sibling].Parent = newParent;
+    Nodes[Leaf].Parent = newParent;
+
+    if (oldParent == NullNode)
+    {
+        Root = newParent;
+    }
+    else if (Nodes[oldParent].Child1 == sibling)
+    {
+        Nodes[oldParent].Child1 = newParent;
+    }
+    else
+    {
+        Nodes[oldParent].Child2 = newParent;
+    }
+
+    Refit(Nodes[Leaf].Parent);
+}
+
+void AABBTree::RemoveLeaf(const unsigned int Leaf)
+{
+    if (Leaf == Root)
+    {
+        Root = NullNode;
+        return;
+    }
+
+    // The leaf's parent goes too, its other child takes the parent's place
+    const unsigned int parent = Nodes[Leaf].Parent;
+    const unsigned int grandParent = Nodes[parent].Parent;
+    const unsigned int sibling = (Nodes[parent].Child1 == Leaf) ? Nodes[parent].Child2 : Nodes[parent].Child1;
+
+    Nodes[sibling].Parent = grandParent;
+    FreeNode(parent);
+
+    if (grandParent == NullNode)
+    {
+        Root = sibling;
+        return;
+    }
+
+    if (Nodes[grandParent].Child1 == parent)
+    {
+        Nodes[grandParent].Child1 = sibling;
+    }
+    else
+    {
+        Nodes[grandParent].Child2 = sibling;
+    }
+
+    Refit(grandParent);
+}
+
+void AABBTree::Refit(unsigned int NodeIdx)
+{
+    while (NodeIdx != NullNode)
+    {
+        NodeIdx = Balance(NodeIdx);
+
+        Node& node = Nodes[NodeIdx];
+        const Node& child1 = Nodes[node.Child1];
+        const Node& child2 = Nodes[node.Child2];
+
+        node.Height = 1 + std::max(child1.Height, child2.Height);
+        node.FatBounds = child1.FatBounds.Union(child2.FatBounds);
+
+        NodeIdx = node.Parent;
+    }
+}
+
+unsigned int AABBTree::Balance(const unsigned int A)
+{
+    Node& a = Nodes[A];
+
+    if (a.IsLeaf() || a.Height < 2)
+    {
+        return A;
+    }
+
+    const int balance = Nodes[a.Child2].Height - Nodes[a.Child1].Height;
+
+    if (balance >= -1 && balance <= 1)
+    {
+        return A;
+    }
+
+    // Whichever child is taller (Up) takes A's place, and A takes Up's shorter child in place of Up
+    const bool rotateChild2 = balance > 1;
+    const unsigned int up = rotateChild2 ? a.Child2 : a.Child1;
+    const unsigned int stay = rotateChild2 ? a.Child1 : a.Child2;
+    Node& upNode = Nodes[up];
+
+    const bool keepUpChild1 = Nodes[upNode.Child1].Height > Nodes[upNode.Child2].Height;
+    const unsigned int kept = keepUpChild1 ? upNode.Child1 : upNode.Child2;
+    const unsigned int given = keepUpChild1 ? upNode.Child2 : upNode.Child1;
+
+    upNode.Parent = a.Parent;
+    a.Parent = up;
+
+    if (upNode.Parent == NullNode)
+    {
+        Root = up;
+    }
+    else if (Nodes[upNode.Parent].Child1 == A)
+    {
+        Nodes[upNode.Parent].Child1 = up;
+    }
+    else
+    {
+        Nodes[upNode.Parent].Child2 = up;
+    }
+
+    a.Child1 = stay;
+    a.Child2 = given;
+    Nodes[given].Parent = A;
+
+    upNode.Child1 = A;
+    upNode.Child2 = kept;
+
+    a.FatBounds = Nodes[stay].FatBounds.Union(Nodes[given].FatBounds);
+    a.Height = 1 + std::max(Nodes[stay].Height, Nodes[given].Height);
+
+    upNode.FatBounds = a.FatBounds.Union(Nodes[kept].FatBounds);
+    upNode.Height = 1 + std::max(a.Height, Nodes[kept].Height);
+
+    return up;
+}
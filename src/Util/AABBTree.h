@@ -0,0 +1,222 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "AABB.h"
+#include <vector>
+#include <cassert>
+
+/**
+ * Dynamic bounding volume hierarchy. Every proxy is a leaf holding a "fat" copy of its box,
+ * grown by Margin on every side, so a proxy that moves a little stays inside its fat box and
+ * the tree is left alone. Only proxies that leave their fat box are taken out and reinserted.
+ * Each branch bounds its two children, and branches are rotated on the way back up from an
+ * insert or removal to keep the tree balanced.
+ *
+ * Nodes live in one vector and refer to each other by index, freed nodes are reused.
+ */
+class AABBTree
+{
+public:
+    static constexpr unsigned int NullNode = static_cast<unsigned int>(-1);
+
+    AABBTree(const float InMargin);
+
+    /** Returns the new proxy. UserData is handed back by GetUserData, e.g. an entity ID. */
+    unsigned int CreateProxy(const AABB& Bounds, const unsigned int UserData);
+
+    void DestroyProxy(const unsigned int Proxy);
+
+    /** Returns true if Bounds left the proxy's fat box, so it had to be reinserted */
+    const bool MoveProxy(const unsigned int Proxy, const AABB& Bounds);
+
+    const unsigned int GetUserData(const unsigned int Proxy) const { return Nodes[Proxy].UserData; }
+
+    /** The box given to CreateProxy or MoveProxy last */
+    const AABB& GetBounds(const unsigned int Proxy) const { return Nodes[Proxy].Bounds; }
+    const AABB& GetFatBounds(const unsigned int Proxy) const { return Nodes[Proxy].FatBounds; }
+
+    const unsigned int GetHeight() const { return (Root == NullNode) ? 0 : Nodes[Root].Height; }
+    const size_t NumProxies() const { return NumLeaves; }
+
+    /**
+     * Calls Fn(unsigned int Proxy) for every proxy whose fat box overlaps Bounds.
+     * Fn returns false to stop the query early.
+     */
+    template <typename TFunc>
+    void Query(const AABB& Bounds, TFunc&& Fn) const;
+
+    /** Calls Fn(unsigned int Proxy) for every proxy whose fat box contains Point, until Fn returns false */
+    template <typename TFunc>
+    void QueryPoint(const glm::vec2 Point, TFunc&& Fn) const;
+
+    /**
+     * Walks the proxies whose fat boxes the segment from Origin to Origin + Delta passes through.
+     * Fn(unsigned int Proxy, float MaxFraction) returns the new MaxFraction (0-1) of the segment
+     * still worth searching - return the fraction of a hit to only look for closer ones, MaxFraction
+     * to carry on unchanged, or 0 to stop.
+     */
+    template <typename TFunc>
+    void Raycast(const glm::vec2 Origin, const glm::vec2 Delta, TFunc&& Fn) const;
+
+private:
+    /** Deep enough for any tree kept balanced, which is never taller than about 1.44 * log2(leaves) */
+    static constexpr unsigned int MaxStackDepth = 256;
+
+    struct Node
+    {
+        AABB FatBounds;
+
+        /** Leaves only */
+        AABB Bounds;
+        unsigned int UserData = 0;
+
+        /** Next free node while this one is unused */
+        unsigned int Parent = NullNode;
+        unsigned int Child1 = NullNode;
+        unsigned int Child2 = NullNode;
+
+        /** 0 for leaves, -1 while unused */
+        int Height = -1;
+
+        const bool IsLeaf() const { return Child1 == NullNode; }
+    };
+
+    unsigned int AllocateNode();
+    void FreeNode(const unsigned int NodeIdx);
+
+    void InsertLeaf(const unsigned int Leaf);
+    void RemoveLeaf(const unsigned int Leaf);
+
+    /** Refits bounds and heights from NodeIdx up to the root, rotating as it goes */
+    void Refit(unsigned int NodeIdx);
+
+    /** Rotates A's taller grandchild up if A's children differ in height by more than one. Returns A's replacement. */
+    unsigned int Balance(const unsigned int A);
+
+    const float Margin;
+
+    std::vector<Node> Nodes;
+    unsigned int Root = NullNode;
+    unsigned int FreeList = NullNode;
+    size_t NumLeaves = 0;
+};
+
+template <typename TFunc>
+void AABBTree::Query(const AABB& Bounds, TFunc&& Fn) const
+{
+    unsigned int stack[MaxStackDepth];
+    unsigned int stackSize = 0;
+
+    if (Root != NullNode)
+    {
+        stack[stackSize++] = Root;
+    }
+
+    while (stackSize > 0)
+    {
+        const Node& node = Nodes[stack[--stackSize]];
+
+        if (node.FatBounds.Overlaps(Bounds) == false)
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            if (Fn(static_cast<unsigned int>(&node - Nodes.data())) == false)
+            {
+                return;
+            }
+        }
+        else
+        {
+            assert(stackSize + 2 <= MaxStackDepth);
+            stack[stackSize++] = node.Child1;
+            stack[stackSize++] = node.Child2;
+        }
+    }
+}
+
+template <typename TFunc>
+void AABBTree::QueryPoint(const glm::vec2 Point, TFunc&& Fn) const
+{
+    unsigned int stack[MaxStackDepth];
+    unsigned int stackSize = 0;
+
+    if (Root != NullNode)
+    {
+        stack[stackSize++] = Root;
+    }
+
+    while (stackSize > 0)
+    {
+        const Node& node = Nodes[stack[--stackSize]];
+
+        if (node.FatBounds.Contains(Point) == false)
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            if (Fn(static_cast<unsigned int>(&node - Nodes.data())) == false)
+            {
+                return;
+            }
+        }
+        else
+        {
+            assert(stackSize + 2 <= MaxStackDepth);
+            stack[stackSize++] = node.Child1;
+            stack[stackSize++] = node.Child2;
+        }
+    }
+}
+
+template <typename TFunc>
+void AABBTree::Raycast(const glm::vec2 Origin, const glm::vec2 Delta, TFunc&& Fn) const
+{
+    float maxFraction = 1.0f;
+
+    unsigned int stack[MaxStackDepth];
+    unsigned int stackSize = 0;
+
+    if (Root != NullNode)
+    {
+        stack[stackSize++] = Root;
+    }
+
+    while (stackSize > 0)
+    {
+        const unsigned int nodeIdx = stack[--stackSize];
+        const Node& node = Nodes[nodeIdx];
+
+        // Skip anything only further along than the closest hit so far
+        float fraction = maxFraction;
+
+        if (node.FatBounds.Raycast(Origin, Delta, fraction) == false)
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            maxFraction = Fn(nodeIdx, maxFraction);
+
+            if (maxFraction <= 0.0f)
+            {
+                return;
+            }
+        }
+        else
+        {
+            assert(stackSize + 2 <= MaxStackDepth);
+            stack[stackSize++] = node.Child1;
+            stack[stackSize++] = node.Child2;
+        }
+    }
+}
@@ -13,8 +13,29 @@ public:
     constexpr static bool IsDebugBuild = _DEBUG;
     static bool DrawDebugColliders;
     constexpr static float OneMillisec = 1.0f / 1000.0f;
-    constexpr static unsigned int MaxNumComponentTypes = 32;
-    constexpr static unsigned int MaxNumEntities = -1;
+    constexpr static unsigned int MaxNumComponentTypes = 256;
+    constexpr static unsigned int EntityIndexBits = 20;
+    constexpr static unsigned int MaxNumEntities = (1u << EntityIndexBits) - 1;
+    constexpr static unsigned int SparsePageSize = 4096;
+    constexpr static unsigned int ArchetypeChunkSize = 16 * 1024;
+    constexpr static unsigned int PoolPageSize = 16 * 1024;
+    constexpr static unsigned int PoolPagesPerBlock = 64;
+    constexpr static unsigned int ParallelChunkSize = 2048;
+
+    /** Side of one BoxCollisionSystem broadphase cell. Best a little larger than a typical collider. */
+    constexpr static float CollisionCellSize = 64.0f;
+
+    /** How far a collider can move before BoxCollisionSystem has to reinsert it into its AABBTree */
+    constexpr static float CollisionTreeMargin = 4.0f;
+
+    /** Length of one simulation tick in seconds. Systems always update by exactly this much. */
+    constexpr static float FixedTimeStep = 1.0f / 60.0f;
+
+    /** Most ticks run to catch up in one frame, any time beyond that is dropped (slow motion, not a spiral) */
+    constexpr static unsigned int MaxTicksPerFrame = 5;
+
+    /** Frames ECSManager keeps for rolling back to, unless told otherwise (see ECSManager::SaveFrame) */
+    constexpr static unsigned int NumRollbackFrames = 8;
 
     static const double Now()
     {
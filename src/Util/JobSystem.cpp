@@ -0,0 +1,191 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "JobSystem.h"
+
+namespace
+{
+    /** Which JobSystem (if any) owns the current thread, and its queue index there */
+    thread_local const JobSystem* CurrentOwner = nullptr;
+    thread_local unsigned int CurrentWorkerIdx = 0;
+}
+
+JobSystem& JobSystem::Get()
+{
+    static JobSystem instance(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    return instance;
+}
+
+JobSystem::JobSystem(const unsigned int NumWorkers)
+{
+    for (unsigned int i = 0; i < NumWorkers; ++i)
+    {
+        Queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    // Queues must all exist before any worker starts stealing from them
+    for (unsigned int i = 0; i < NumWorkers; ++i)
+    {
+        Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        ShuttingDown = true;
+    }
+    WorkAvailable.notify_all();
+
+    for (std::thread& worker : Workers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::Submit(Job InJob)
+{
+    if (Queues.empty())
+    {
+        // No workers to hand it to
+        InJob();
+        return;
+    }
+
+    unsigned int queueIdx = GetCurrentQueue();
+
+    if (queueIdx == Queues.size())
+    {
+        queueIdx = NextQueue.fetch_add(1, std::memory_order_relaxed) % Queues.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(Queues[queueIdx]->Mutex);
+        Queues[queueIdx]->Jobs.push_back(std::move(InJob));
+    }
+
+    NumQueuedJobs.fetch_add(1);
+
+    {
+        // Taking the lock orders this with a worker's check-then-sleep so the wake-up can't be lost
+        std::lock_guard<std::mutex> lock(SleepMutex);
+    }
+    WorkAvailable.notify_one();
+}
+
+void JobSystem::ParallelFor(const size_t Count, const size_t RangeSize, const std::function<void(size_t, size_t)>& Fn)
+{
+    if (Count == 0)
+    {
+        return;
+    }
+
+    const size_t rangeSize = (RangeSize > 0) ? RangeSize : 1;
+
+    if (Queues.empty() || Count <= rangeSize)
+    {
+        Fn(0, Count);
+        return;
+    }
+
+    const size_t numRanges = (Count + rangeSize - 1) / rangeSize;
+    std::atomic<size_t> numRemaining{ numRanges };
+
+    // Keep the first range for ourselves, hand the rest out
+    for (size_t range = 1; range < numRanges; ++range)
+    {
+        const size_t begin = range * rangeSize;
+        const size_t end = (begin + rangeSize < Count) ? begin + rangeSize : Count;
+
+        Submit([&Fn, &numRemaining, begin, end]()
+        {
+            Fn(begin, end);
+            numRemaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    Fn(0, rangeSize);
+    numRemaining.fetch_sub(1, std::memory_order_release);
+
+    // Help out rather than block until the stragglers are done
+    const unsigned int currentQueue = GetCurrentQueue();
+
+    while (numRemaining.load(std::memory_order_acquire) > 0)
+    {
+        if (TryRunJob(currentQueue) == false)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+const bool JobSystem::TryRunJob(const unsigned int Preferred)
+{
+    Job job;
+    const auto numQueues = static_cast<unsigned int>(Queues.size());
+
+    if (Preferred < numQueues)
+    {
+        WorkQueue& queue = *Queues[Preferred];
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+
+        if (queue.Jobs.empty() == false)
+        {
+            job = std::move(queue.Jobs.back());
+            queue.Jobs.pop_back();
+        }
+    }
+
+    // Steal, starting with our neighbour so thieves don't all pile onto queue 0
+    for (unsigned int offset = 1; job == nullptr && offset <= numQueues; ++offset)
+    {
+        WorkQueue& victim = *Queues[(Preferred + offset) % numQueues];
+        std::lock_guard<std::mutex> lock(victim.Mutex);
+
+        if (victim.Jobs.empty() == false)
+        {
+            job = std::move(victim.Jobs.front());
+            victim.Jobs.pop_front();
+        }
+    }
+
+    if (job == nullptr)
+    {
+        return false;
+    }
+
+    NumQueuedJobs.fetch_sub(1);
+    job();
+
+    return true;
+}
+
+void JobSystem::WorkerLoop(const unsigned int WorkerIdx)
+{
+    CurrentOwner = this;
+    CurrentWorkerIdx = WorkerIdx;
+
+    while (true)
+    {
+        if (TryRunJob(WorkerIdx))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(SleepMutex);
+        WorkAvailable.wait(lock, [this] { return ShuttingDown || NumQueuedJobs.load() > 0; });
+
+        if (ShuttingDown && NumQueuedJobs.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+const unsigned int JobSystem::GetCurrentQueue() const
+{
+    return (CurrentOwner == this) ? CurrentWorkerIdx : static_cast<unsigned int>(Queues.size());
+}
\ No newline at end of file
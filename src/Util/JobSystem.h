@@ -0,0 +1,74 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Work-stealing pool of worker threads.
+ * Every worker owns a queue. Jobs submitted from a worker go on the back of its own queue
+ * and it pops from the back (most recent, cache-warm work first); jobs submitted from any
+ * other thread are spread round-robin. A worker whose queue runs dry steals from the front
+ * of the others' queues before going to sleep.
+ *
+ * One engine-wide instance (Get()) sized to the machine's cores, minus one for the main thread.
+ */
+class JobSystem
+{
+public:
+    typedef std::function<void()> Job;
+
+    static JobSystem& Get();
+
+    JobSystem(const unsigned int NumWorkers);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    const unsigned int GetNumWorkers() const { return static_cast<unsigned int>(Workers.size()); }
+
+    /** Queues InJob to run on a worker */
+    void Submit(Job InJob);
+
+    /**
+     * Splits [0, Count) into ranges of at most RangeSize and calls Fn(Begin, End) once per range,
+     * spread across the workers. The calling thread runs jobs too and only returns once every
+     * range is done, so this is safe to call from inside another job.
+     */
+    void ParallelFor(const size_t Count, const size_t RangeSize, const std::function<void(size_t, size_t)>& Fn);
+
+private:
+    struct WorkQueue
+    {
+        std::mutex Mutex;
+        std::deque<Job> Jobs;
+    };
+
+    /** Runs one job from queue Preferred (newest first) or else steals one from another queue (oldest first) */
+    const bool TryRunJob(const unsigned int Preferred);
+
+    void WorkerLoop(const unsigned int WorkerIdx);
+
+    /** Index of the calling thread's queue, or Queues.size() for threads that aren't our workers */
+    const unsigned int GetCurrentQueue() const;
+
+    std::vector<std::thread> Workers;
+    std::vector<std::unique_ptr<WorkQueue>> Queues;
+    std::atomic<unsigned int> NextQueue{ 0 };
+    std::atomic<int> NumQueuedJobs{ 0 };
+
+    std::mutex SleepMutex;
+    std::condition_variable WorkAvailable;
+    bool ShuttingDown = false;
+};
\ No newline at end of file
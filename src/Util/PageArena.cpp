@@ -0,0 +1,47 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "PageArena.h"
+#include <new>
+#include <cassert>
+
+PageArena::PageArena(const size_t InPageSize, const size_t InPagesPerBlock)
+    : PageSize(InPageSize), PagesPerBlock(InPagesPerBlock > 0 ? InPagesPerBlock : 1)
+{
+    assert(PageSize > 0 && PageSize % PageAlignment == 0);
+}
+
+PageArena::~PageArena()
+{
+    for (unsigned char* block : Blocks)
+    {
+        ::operator delete(block, std::align_val_t(PageAlignment));
+    }
+}
+
+void* PageArena::AllocatePage()
+{
+    if (FreePages.empty() == false)
+    {
+        void* page = FreePages.back();
+        FreePages.pop_back();
+        return page;
+    }
+
+    if (Blocks.empty() || NumUsedInBlock == PagesPerBlock)
+    {
+        Blocks.push_back(static_cast<unsigned char*>(::operator new(PageSize * PagesPerBlock, std::align_val_t(PageAlignment))));
+        NumUsedInBlock = 0;
+    }
+
+    ++NumPagesAllocated;
+    return Blocks.back() + PageSize * NumUsedInBlock++;
+}
+
+void PageArena::FreePage(void* Page)
+{
+    assert(Page != nullptr);
+    FreePages.push_back(Page);
+}
@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * Hands out fixed-size pages carved from much larger blocks.
+ * Freed pages go on a free list to be handed out again, blocks are only released when the
+ * arena is destroyed. A page never moves once handed out, and growing never copies anything
+ * or needs the old and new memory at the same time.
+ *
+ * Not thread-safe.
+ */
+class PageArena
+{
+public:
+    /** Every page is aligned to this */
+    static constexpr size_t PageAlignment = 64;
+
+    /** PageSize must be a multiple of PageAlignment */
+    PageArena(const size_t InPageSize, const size_t InPagesPerBlock);
+    ~PageArena();
+
+    PageArena(const PageArena&) = delete;
+    PageArena& operator=(const PageArena&) = delete;
+
+    const size_t GetPageSize() const { return PageSize; }
+
+    /** Number of pages currently handed out */
+    const size_t NumPagesInUse() const { return NumPagesAllocated - FreePages.size(); }
+
+    void* AllocatePage();
+
+    /** Page must have come from this arena. It is not cleared. */
+    void FreePage(void* Page);
+
+private:
+    const size_t PageSize;
+    const size_t PagesPerBlock;
+
+    std::vector<unsigned char*> Blocks;
+    std::vector<void*> FreePages;
+
+    /** Pages carved out of the newest block so far */
+    size_t NumUsedInBlock = 0;
+    size_t NumPagesAllocated = 0;
+};
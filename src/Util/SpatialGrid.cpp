@@ -0,0 +1,124 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "SpatialGrid.h"
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(const float InCellSize)
+    : CellSize(InCellSize), InverseCellSize(1.0f / InCellSize)
+{
+    assert(CellSize > 0.0f);
+}
+
+SpatialGrid::Cell SpatialGrid::ToCell(const float X, const float Y) const
+{
+    return { static_cast<int>(std::floor(X * InverseCellSize)), static_cast<int>(std::floor(Y * InverseCellSize)) };
+}
+
+unsigned int SpatialGrid::BucketOf(const Cell& InCell) const
+{
+    const auto hash = (static_cast<unsigned int>(InCell.X) * 73856093u) ^ (static_cast<unsigned int>(InCell.Y) * 19349663u);
+    return hash & BucketMask;
+}
+
+void SpatialGrid::Build(const std::vector<AABB>& Bounds)
+{
+    Ranges.resize(Bounds.size());
+
+    size_t numEntries = 0;
+
+    for (size_t idx = 0; idx < Bounds.size(); ++idx)
+    {
+        const CellRange range = { ToCell(Bounds[idx].Min.x, Bounds[idx].Min.y), ToCell(Bounds[idx].Max.x, Bounds[idx].Max.y) };
+        Ranges[idx] = range;
+        numEntries += static_cast<size_t>(range.Last.X - range.First.X + 1) * (range.Last.Y - range.First.Y + 1);
+    }
+
+    // Roughly one bucket per entry keeps most buckets down to a single cell
+    unsigned int numBuckets = 64;
+
+    while (numBuckets < numEntries)
+    {
+        numBuckets *= 2;
+    }
+
+    BucketMask = numBuckets - 1;
+    BucketStarts.assign(numBuckets + 1, 0);
+    Entries.resize(numEntries);
+
+    for (const CellRange& range : Ranges)
+    {
+        for (int y = range.First.Y; y <= range.Last.Y; ++y)
+        {
+            for (int x = range.First.X; x <= range.Last.X; ++x)
+            {
+                ++BucketStarts[BucketOf({ x, y }) + 1];
+            }
+        }
+    }
+
+    for (unsigned int bucket = 0; bucket < numBuckets; ++bucket)
+    {
+        BucketStarts[bucket + 1] += BucketStarts[bucket];
+    }
+
+    // Fill each bucket from its start, then shift the starts back into place
+    for (unsigned int idx = 0; idx < Ranges.size(); ++idx)
+    {
+        const CellRange& range = Ranges[idx];
+
+        for (int y = range.First.Y; y <= range.Last.Y; ++y)
+        {
+            for (int x = range.First.X; x <= range.Last.X; ++x)
+            {
+                const Cell cell = { x, y };
+                Entries[BucketStarts[BucketOf(cell)]++] = { cell, idx };
+            }
+        }
+    }
+
+    for (unsigned int bucket = numBuckets; bucket > 0; --bucket)
+    {
+        BucketStarts[bucket] = BucketStarts[bucket - 1];
+    }
+
+    BucketStarts[0] = 0;
+}
+
+void SpatialGrid::FindPairs(std::vector<std::pair<unsigned int, unsigned int>>& OutPairs) const
+{
+    for (size_t bucket = 0; bucket + 1 < BucketStarts.size(); ++bucket)
+    {
+        const unsigned int end = BucketStarts[bucket + 1];
+
+        for (unsigned int i = BucketStarts[bucket]; i < end; ++i)
+        {
+            const Entry& a = Entries[i];
+            const CellRange& aRange = Ranges[a.Index];
+
+            for (unsigned int j = i + 1; j < end; ++j)
+            {
+                const Entry& b = Entries[j];
+
+                // Buckets can hold more than one cell
+                if ((a.InCell == b.InCell) == false)
+                {
+                    continue;
+                }
+
+                // Boxes sharing several cells are only paired in the first of them
+                const CellRange& bRange = Ranges[b.Index];
+                const Cell firstShared = { std::max(aRange.First.X, bRange.First.X), std::max(aRange.First.Y, bRange.First.Y) };
+
+                if (a.InCell == firstShared)
+                {
+                    OutPairs.emplace_back(std::min(a.Index, b.Index), std::max(a.Index, b.Index));
+                }
+            }
+        }
+    }
+}
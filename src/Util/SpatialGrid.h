@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "AABB.h"
+#include <vector>
+#include <utility>
+
+/**
+ * Broadphase that hashes boxes into a uniform grid of square cells, so only boxes that share
+ * a cell are ever paired up. Each box is entered into every cell it touches.
+ *
+ * The grid is rebuilt from scratch by every Build: cells are hashed into buckets and the
+ * entries counting-sorted by bucket, so there are no per-cell allocations and a rebuild is
+ * linear in the number of entries. Works best when most boxes span only a few cells - a box
+ * much larger than CellSize is entered into (and paired up in) every one of its cells.
+ */
+class SpatialGrid
+{
+public:
+    SpatialGrid(const float InCellSize);
+
+    const float GetCellSize() const { return CellSize; }
+
+    /** Replaces the grid's contents with Bounds, indexed the same way */
+    void Build(const std::vector<AABB>& Bounds);
+
+    /**
+     * Appends every pair of indices into the last Build's Bounds that share at least one cell,
+     * each pair once and lower index first. The boxes themselves may still not overlap.
+     */
+    void FindPairs(std::vector<std::pair<unsigned int, unsigned int>>& OutPairs) const;
+
+private:
+    struct Cell
+    {
+        int X;
+        int Y;
+
+        bool operator==(const Cell& Other) const { return X == Other.X && Y == Other.Y; }
+    };
+
+    /** One box in one cell */
+    struct Entry
+    {
+        Cell InCell;
+        unsigned int Index;
+    };
+
+    /** The range of cells a box touches, inclusive */
+    struct CellRange
+    {
+        Cell First;
+        Cell Last;
+    };
+
+    Cell ToCell(const float X, const float Y) const;
+    unsigned int BucketOf(const Cell& InCell) const;
+
+    const float CellSize;
+    const float InverseCellSize;
+
+    std::vector<CellRange> Ranges;
+
+    /** Every entry sorted by bucket, BucketStarts[i] indicates where bucket i starts in Entries */
+    std::vector<Entry> Entries;
+    std::vector<unsigned int> BucketStarts;
+    unsigned int BucketMask = 0;
+};
@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <cassert>
+
+void SweepAndPrune::SetBounds(const unsigned int ID, const AABB& Bounds)
+{
+    assert((ID & MaxBit) == 0);
+
+    if (ID >= Boxes.size())
+    {
+        Boxes.resize(ID + 1);
+        LastSeen.resize(ID + 1, 0);
+        ActiveSlots.resize(ID + 1, NullIndex);
+    }
+
+    // Proxies seen last time (or already this time) have their endpoints in the list
+    if (LastSeen[ID] + 1 < Stamp)
+    {
+        Endpoints.push_back({ Bounds.Min.x, ID });
+        Endpoints.push_back({ Bounds.Max.x, ID | MaxBit });
+        ++NumAdded;
+    }
+
+    Boxes[ID] = Bounds;
+    LastSeen[ID] = Stamp;
+}
+
+void SweepAndPrune::RefreshEndpoints()
+{
+    size_t numKept = 0;
+
+    for (const Endpoint& endpoint : Endpoints)
+    {
+        const unsigned int id = endpoint.GetID();
+
+        if (LastSeen[id] == Stamp)
+        {
+            const float value = endpoint.IsMax() ? Boxes[id].Max.x : Boxes[id].Min.x;
+            Endpoints[numKept++] = { value, endpoint.Proxy };
+        }
+    }
+
+    Endpoints.resize(numKept);
+}
+
+void SweepAndPrune::SortEndpoints()
+{
+    // A big batch of new proxies at the end would make the insertion sort quadratic
+    if (NumAdded * 8 > NumProxies())
+    {
+        std::sort(Endpoints.begin(), Endpoints.end());
+        return;
+    }
+
+    for (size_t idx = 1; idx < Endpoints.size(); ++idx)
+    {
+        const Endpoint endpoint = Endpoints[idx];
+        size_t hole = idx;
+
+        while (hole > 0 && endpoint < Endpoints[hole - 1])
+        {
+            Endpoints[hole] = Endpoints[hole - 1];
+            --hole;
+        }
+
+        Endpoints[hole] = endpoint;
+    }
+}
+
+void SweepAndPrune::FindPairs(std::vector<std::pair<unsigned int, unsigned int>>& OutPairs)
+{
+    RefreshEndpoints();
+    SortEndpoints();
+
+    // Every box whose min X has been passed but not its max X
+    for (const Endpoint& endpoint : Endpoints)
+    {
+        const unsigned int id = endpoint.GetID();
+
+        if (endpoint.IsMax())
+        {
+            const unsigned int slot = ActiveSlots[id];
+            Active[slot] = Active.back();
+            ActiveSlots[Active[slot]] = slot;
+            Active.pop_back();
+            ActiveSlots[id] = NullIndex;
+            continue;
+        }
+
+        const AABB& box = Boxes[id];
+
+        for (const unsigned int other : Active)
+        {
+            const AABB& otherBox = Boxes[other];
+
+            // Boxes that only touch on X are both open here, since mins sort first
+            if (box.Min.x < otherBox.Max.x && box.Min.y < otherBox.Max.y && otherBox.Min.y < box.Max.y)
+            {
+                OutPairs.emplace_back(std::min(id, other), std::max(id, other));
+            }
+        }
+
+        ActiveSlots[id] = static_cast<unsigned int>(Active.size());
+        Active.push_back(id);
+    }
+
+    assert(Active.empty());
+
+    ++Stamp;
+    NumAdded = 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2024 Sean Goldie. All rights reserved.
+ * Contact: sean.writes.code@gmail.com
+ */
+
+#pragma once
+
+#include "AABB.h"
+#include <vector>
+#include <utility>
+
+/**
+ * Broadphase that keeps every box's min and max X as endpoints in one sorted list, then
+ * sweeps it to pair up boxes whose X ranges overlap. The list persists between calls and
+ * is re-sorted with an insertion sort, which is close to linear when boxes move little from
+ * one frame to the next. Unlike SpatialGrid, very large and very small boxes cost the same.
+ *
+ * Boxes are proxies keyed by a caller-chosen ID (e.g. an entity ID), kept small as storage
+ * is indexed directly by it.
+ */
+class SweepAndPrune
+{
+public:
+    /** Adds proxy ID, or moves it if it already exists */
+    void SetBounds(const unsigned int ID, const AABB& Bounds);
+
+    /**
+     * Appends the IDs of every pair of proxies whose boxes overlap on X and Y, each pair once
+     * and lower ID first. Proxies that were not given bounds since the last call are removed first.
+     */
+    void FindPairs(std::vector<std::pair<unsigned int, unsigned int>>& OutPairs);
+
+    const size_t NumProxies() const { return Endpoints.size() / 2; }
+
+private:
+    /** Set in Endpoint::Proxy for the max end of a box */
+    static constexpr unsigned int MaxBit = 1u << 31;
+    static constexpr unsigned int NullIndex = static_cast<unsigned int>(-1);
+
+    struct Endpoint
+    {
+        float Value;
+        unsigned int Proxy;
+
+        const unsigned int GetID() const { return Proxy & ~MaxBit; }
+        const bool IsMax() const { return (Proxy & MaxBit) != 0; }
+
+        /** Ends at the same X sort min first, so a zero-width box still opens before it closes */
+        bool operator<(const Endpoint& Other) const
+        {
+            return Value < Other.Value || (Value == Other.Value && IsMax() == false && Other.IsMax());
+        }
+    };
+
+    /** Re-reads every endpoint's value, dropping the endpoints of stale proxies */
+    void RefreshEndpoints();
+
+    void SortEndpoints();
+
+    /** Index indicates proxy ID */
+    std::vector<AABB> Boxes;
+    std::vector<unsigned int> LastSeen;
+
+    /** Position in Active while the sweep is inside a box, otherwise NullIndex */
+    std::vector<unsigned int> ActiveSlots;
+
+    std::vector<Endpoint> Endpoints;
+    std::vector<unsigned int> Active;
+
+    /**
+     * Bumped every FindPairs, proxies not stamped with the current one are stale.
+     * Starts at 2 so proxies that were never seen (stamped 0) are never mistaken for ones seen last time.
+     */
+    unsigned int Stamp = 2;
+    unsigned int NumAdded = 0;
+};